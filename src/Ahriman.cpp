@@ -1,107 +1,307 @@
 #include "plugin.hpp"
 #include "dsp/dsp.hpp"
+#include "dsp/Convolver.hpp"
+#include "dsp/SwapSlot.hpp"
+#include <osdialog.h>
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
 #include <random>
+#include <string>
+#include <thread>
 #include <vector>
+#ifdef ARCH_LIN
+#include <sys/mman.h>
+#endif
+
+using simd::float_4;
 
 namespace {
-static constexpr int NUM_DELAY_LINES = 4;
+static constexpr int MAX_DELAY_LINES = 16;
+static constexpr int MAX_LINE_GROUPS = MAX_DELAY_LINES / 4;
+static constexpr int FDN_LINE_OPTIONS[3] = {4, 8, 16};
+static constexpr float IR_MAX_SECONDS = 12.f;
+static constexpr int SHIMMER_INTERVALS[4] = {12, -12, 7, 19};
+
+// Per-line tables, 16 entries. An N-line tank uses the first N, so the
+// 4-line tank keeps the original prime-based multipliers and mod scales.
+static const float FDN_MULTIPLIERS[MAX_DELAY_LINES] = {
+        0.37f, 0.53f, 0.73f, 0.97f, 0.43f, 0.61f, 0.83f, 0.89f,
+        0.31f, 0.41f, 0.47f, 0.59f, 0.67f, 0.71f, 0.79f, 0.29f};
+static const float FDN_MOD_SCALES[MAX_DELAY_LINES] = {
+        1.0f, -0.8f, 0.6f, -0.5f, 0.9f, -0.7f, 0.55f, -0.45f,
+        0.95f, -0.85f, 0.65f, -0.55f, 0.75f, -0.6f, 0.5f, -0.4f};
+
+// H4 on the lanes of one vector, rows in the order
+// [[1,1,1,1], [1,-1,1,-1], [1,1,-1,-1], [1,-1,-1,1]]
+inline float_4 hadamard4(float_4 v) {
+        float_4 p = _mm_shuffle_ps(v.v, v.v, _MM_SHUFFLE(2, 2, 0, 0));
+        float_4 q = _mm_shuffle_ps(v.v, v.v, _MM_SHUFFLE(3, 3, 1, 1));
+        float_4 s = p + q * float_4(1.f, -1.f, 1.f, -1.f);
+        p = _mm_shuffle_ps(s.v, s.v, _MM_SHUFFLE(1, 0, 1, 0));
+        q = _mm_shuffle_ps(s.v, s.v, _MM_SHUFFLE(3, 2, 3, 2));
+        return p + q * float_4(1.f, 1.f, -1.f, -1.f);
+}
+
+// Orthonormal fast Walsh-Hadamard transform over 4 * groups lines: H4 inside
+// each vector, then butterflies between vectors
+inline void hadamardMix(float_4* x, int groups) {
+        for (int k = 0; k < groups; ++k)
+                x[k] = hadamard4(x[k]);
+        for (int h = 1; h < groups; h *= 2) {
+                for (int k = 0; k < groups; k += 2 * h) {
+                        for (int j = k; j < k + h; ++j) {
+                                float_4 a = x[j];
+                                float_4 b = x[j + h];
+                                x[j] = a + b;
+                                x[j + h] = a - b;
+                        }
+                }
+        }
+        float norm = 1.f / std::sqrt(4.f * groups);
+        for (int k = 0; k < groups; ++k)
+                x[k] *= norm;
+}
+
+inline float horizontalSum(float_4 v) {
+        return v[0] + v[1] + v[2] + v[3];
+}
+
+inline int nextPowerOfTwo(int n) {
+        int p = 1;
+        while (p < n)
+                p <<= 1;
+        return p;
+}
+
+// All delay memory of one instance: the interleaved FDN lines followed by
+// the two shimmer buffers, every region a power of two. It is one zeroed
+// allocation, always built off the audio thread. Blocks of at least
+// HUGE_PAGE_MIN are aligned and padded to 2 MB so they can be backed by huge
+// pages; below that the padding would cost more than the TLB misses it saves.
+struct DelayMemory {
+        static constexpr size_t HUGE_PAGE = 2u << 20;
+        static constexpr size_t HUGE_PAGE_MIN = 8 * HUGE_PAGE;
+        static constexpr size_t CACHE_LINE = 64;
+
+        float sampleRate = 0.f;
+        int lines = 0;
+        int tankLength = 0;    // frames per line
+        int maxDelay = 0;      // longest usable FDN delay in samples
+        int shimmerLength = 0; // per side
+        void* raw = nullptr;
+        float* data = nullptr;
+
+        DelayMemory(float rate, int numLines, int shimmerFrames) {
+                sampleRate = rate;
+                lines = numLines;
+                maxDelay = (int)std::ceil(sampleRate * 3.5f);
+                tankLength = nextPowerOfTwo(maxDelay + 8);
+                shimmerLength = shimmerFrames;
+                size_t floats = (size_t)tankLength * lines + 2 * (size_t)shimmerLength;
+                size_t bytes = floats * sizeof(float);
+                bool huge = bytes >= HUGE_PAGE_MIN;
+                size_t alignment = huge ? HUGE_PAGE : CACHE_LINE;
+                bytes = (bytes + alignment - 1) / alignment * alignment;
+                raw = std::malloc(bytes + alignment);
+                if (!raw)
+                        throw std::bad_alloc();
+                uintptr_t aligned = ((uintptr_t)raw + alignment - 1) & ~(uintptr_t)(alignment - 1);
+                data = (float*)aligned;
+#ifdef ARCH_LIN
+                if (huge)
+                        madvise(data, bytes, MADV_HUGEPAGE);
+#endif
+                std::memset(data, 0, bytes);
+        }
 
-struct DelayLine {
-        std::vector<float> buffer;
-        int writeIndex = 0;
+        ~DelayMemory() {
+                std::free(raw);
+        }
 
-        void init(size_t size) {
-                buffer.assign(size, 0.f);
-                writeIndex = 0;
+        DelayMemory(const DelayMemory&) = delete;
+        DelayMemory& operator=(const DelayMemory&) = delete;
+
+        float* tank() const {
+                return data;
         }
 
-        float read(float delay) const {
-                if (buffer.empty())
-                        return 0.f;
+        float* shimmer(int side) const {
+                return data + (size_t)tankLength * lines + (size_t)side * shimmerLength;
+        }
+};
+
+// Delay interpolation tiers, cheapest first. Reads per line and sample:
+// linear 2, Hermite 4, allpass 2 plus a feedback state per line.
+enum Interpolation {
+        INTERP_LINEAR,
+        INTERP_HERMITE,
+        INTERP_ALLPASS,
+        INTERP_LEN
+};
 
-                float size = (float)buffer.size();
-                float readIndex = (float)writeIndex - delay;
-                while (readIndex < 0.f)
-                        readIndex += size;
-                while (readIndex >= size)
-                        readIndex -= size;
+inline float_4 gather(const float* base, simd::int32_4 index) {
+        return float_4(base[index[0]], base[index[1]], base[index[2]], base[index[3]]);
+}
+
+// The FDN delay lines as a view into DelayMemory, interleaved so frame t of
+// line i lives at (t & mask) * lines + i. A frame is written with float_4
+// stores and every read wraps with the mask.
+struct FdnArena {
+        float* data = nullptr;
+        int lines = 0;
+        int mask = 0;
+        int writeIndex = 0;
+        float_4 allpassState[MAX_LINE_GROUPS];
 
-                int index0 = (int)std::floor(readIndex);
-                int index1 = (index0 + 1) % buffer.size();
-                float frac = readIndex - (float)index0;
-                float a = buffer[index0];
-                float b = buffer[index1];
-                return rack::math::crossfade(a, b, frac);
+        void attach(float* memory, int numLines, int length) {
+                data = memory;
+                lines = numLines;
+                mask = length - 1;
+                writeIndex = 0;
+                for (float_4& state : allpassState)
+                        state = 0.f;
         }
 
-        void write(float sample) {
-                if (buffer.empty())
-                        return;
-                buffer[writeIndex] = sample;
-                writeIndex++;
-                if (writeIndex >= (int)buffer.size())
-                        writeIndex = 0;
+        // Taps of every line at once. Row and flat indices are computed on
+        // int32_4 lanes, then each tap is a four-lane gather. Delays must be
+        // at least 2 so the Hermite and allpass taps ahead of the read point
+        // have been written.
+        void readAll(const float_4* delay, float_4* out, Interpolation interp) {
+                const simd::int32_4 rowMask(mask);
+                const simd::int32_4 stride(lines);
+                const simd::int32_4 write(writeIndex);
+                for (int k = 0; k < lines / 4; ++k) {
+                        float_4 whole = simd::floor(delay[k]);
+                        float_4 t = delay[k] - whole;
+                        const simd::int32_4 lane(4 * k, 4 * k + 1, 4 * k + 2, 4 * k + 3);
+                        // Row of the newer neighbour x0; x1 is one frame older
+                        simd::int32_4 row0 = (write - simd::int32_4(whole)) & rowMask;
+                        float_4 x0 = gather(data, row0 * stride + lane);
+
+                        if (interp == INTERP_HERMITE) {
+                                float_4 xm1 = gather(data, ((row0 + 1) & rowMask) * stride + lane);
+                                float_4 x1 = gather(data, ((row0 - 1) & rowMask) * stride + lane);
+                                float_4 x2 = gather(data, ((row0 - 2) & rowMask) * stride + lane);
+                                float_4 c1 = 0.5f * (x1 - xm1);
+                                float_4 c2 = xm1 - 2.5f * x0 + 2.f * x1 - 0.5f * x2;
+                                float_4 c3 = 0.5f * (x2 - xm1) + 1.5f * (x0 - x1);
+                                out[k] = ((c3 * t + c2) * t + c1) * t + x0;
+                        } else if (interp == INTERP_ALLPASS) {
+                                // First-order Thiran allpass over the integer delay
+                                // whole - 1 and fraction t + 1 in [1, 2), which keeps
+                                // the coefficient in (-1/3, 0]
+                                float_4 xm1 = gather(data, ((row0 + 1) & rowMask) * stride + lane);
+                                float_4 eta = -t / (2.f + t);
+                                float_4 y = eta * xm1 + x0 - eta * allpassState[k];
+                                allpassState[k] = y;
+                                out[k] = y;
+                        } else {
+                                float_4 x1 = gather(data, ((row0 - 1) & rowMask) * stride + lane);
+                                out[k] = x0 + (x1 - x0) * t;
+                        }
+                }
+        }
+
+        void write(const float_4* frame) {
+                float* dst = data + writeIndex * lines;
+                for (int k = 0; k < lines / 4; ++k)
+                        frame[k].store(dst + 4 * k);
+                writeIndex = (writeIndex + 1) & mask;
         }
 };
 
-// Delay-based pitch shifter for shimmer reverb (octave up)
+// Granular delay-line pitch shifter for the shimmer. Two grains half a cycle
+// apart read the buffer through delays sweeping at (1 - ratio) samples per
+// sample, faded by Hann windows (looked up from the shared sine table) that
+// sum to unity. The high-quality setting doubles the grain length, which
+// lowers the grain-switching modulation, and reads with Hermite
+// interpolation.
 struct PitchShifter {
-        static constexpr int GRAIN_SIZE = 1024;  // Smaller grains for more responsive shimmer
-        static constexpr int NUM_GRAINS = 4;     // More grains for smoother output
+        static constexpr float GRAIN_SECONDS = 0.04f;
 
-        std::vector<float> buffer;
+        float* buffer = nullptr;
+        int mask = 0;
         int writePos = 0;
-        float grainPhases[NUM_GRAINS] = {0.f, 0.25f, 0.5f, 0.75f}; // Evenly spaced grains
+        float sampleRate = 44100.f;
+        float grainLength = 1764.f;
+        float phase = 0.f;  // grain 0, in cycles
+        float phaseStep = 0.f;
+        float ratio = 2.f;
+        int semitones = 12;
+        bool highQuality = false;
+
+        // Buffer frames needed for the long high-quality grains
+        static int bufferLength(float sampleRate) {
+                return nextPowerOfTwo((int)(2.f * GRAIN_SECONDS * sampleRate) + 8);
+        }
 
-        void init(int sampleRate) {
-                buffer.assign(GRAIN_SIZE * 6, 0.f);
+        // memory holds bufferLength(newSampleRate) zeroed frames
+        void attach(float newSampleRate, float* memory, int length) {
+                sampleRate = newSampleRate;
+                buffer = memory;
+                mask = length - 1;
                 writePos = 0;
-                for (int i = 0; i < NUM_GRAINS; ++i) {
-                        grainPhases[i] = (float)i / (float)NUM_GRAINS;
-                }
+                phase = 0.f;
+                updateGrain();
+        }
+
+        void configure(int newSemitones, bool newHighQuality) {
+                if (newSemitones == semitones && newHighQuality == highQuality)
+                        return;
+                semitones = newSemitones;
+                highQuality = newHighQuality;
+                ratio = std::pow(2.f, semitones / 12.f);
+                updateGrain();
+        }
+
+        void updateGrain() {
+                grainLength = std::round((highQuality ? 2.f : 1.f) * GRAIN_SECONDS * sampleRate);
+                phaseStep = std::fabs(1.f - ratio) / grainLength;
         }
 
         void write(float sample) {
                 buffer[writePos] = sample;
-                writePos = (writePos + 1) % buffer.size();
-        }
-
-        float processOctaveUp(float sampleRate) {
-                if (buffer.empty())
-                        return 0.f;
-
-                float output = 0.f;
-                float grainLen = GRAIN_SIZE;
-
-                // Process overlapping grains with window crossfading
-                for (int g = 0; g < NUM_GRAINS; ++g) {
-                        // Grain phase advances at half speed (octave up = 2x pitch = 0.5x playback speed)
-                        grainPhases[g] += 0.5f;
-                        if (grainPhases[g] >= grainLen)
-                                grainPhases[g] -= grainLen;
-
-                        // Calculate read position with delay
-                        float readOffset = grainPhases[g];
-                        int readPos = writePos - (int)readOffset - GRAIN_SIZE * 2;
-                        while (readPos < 0)
-                                readPos += buffer.size();
-                        readPos = readPos % buffer.size();
-
-                        // Linear interpolation for sample reading
-                        int nextPos = (readPos + 1) % buffer.size();
-                        float frac = readOffset - std::floor(readOffset);
-                        float sample = rack::math::crossfade(buffer[readPos], buffer[nextPos], frac);
-
-                        // Hann window for smooth grain envelope (reduces artifacts)
-                        float windowPhase = grainPhases[g] / grainLen;
-                        float window = 0.5f - 0.5f * std::cos(2.f * M_PI * windowPhase);
-                        output += sample * window;
-                }
+                writePos = (writePos + 1) & mask;
+        }
 
-                return output * (1.f / NUM_GRAINS); // Normalize for NUM_GRAINS overlapping
+        // delay >= 1, in samples behind the newest one
+        float read(float delay) const {
+                int whole = (int)delay;
+                float t = delay - whole;
+                int i = writePos - 1 - whole;
+                float x0 = buffer[i & mask];
+                float x1 = buffer[(i - 1) & mask];
+                if (!highQuality)
+                        return x0 + (x1 - x0) * t;
+                float xm1 = buffer[(i + 1) & mask];
+                float x2 = buffer[(i - 2) & mask];
+                float c1 = 0.5f * (x1 - xm1);
+                float c2 = xm1 - 2.5f * x0 + 2.f * x1 - 0.5f * x2;
+                float c3 = 0.5f * (x2 - xm1) + 1.5f * (x0 - x1);
+                return ((c3 * t + c2) * t + c1) * t + x0;
+        }
+
+        float process() {
+                phase += phaseStep;
+                if (phase >= 1.f)
+                        phase -= 1.f;
+
+                // The second grain runs half a cycle behind, so its Hann window
+                // is the complement of the first
+                float other = phase < 0.5f ? phase + 0.5f : phase - 0.5f;
+                float window = 0.5f - 0.5f * SineTable::get()(phase + 0.25f);
+                // Rising pitch reads through a shrinking delay, falling through a growing one
+                bool rising = ratio > 1.f;
+                float delayA = 1.f + grainLength * (rising ? 1.f - phase : phase);
+                float delayB = 1.f + grainLength * (rising ? 1.f - other : other);
+                return window * read(delayA) + (1.f - window) * read(delayB);
         }
 };
 
@@ -148,26 +348,79 @@ struct Ahriman : Module {
                 NUM_LIGHTS
         };
 
-        DelayLine delayLines[NUM_DELAY_LINES];
-        std::array<float, NUM_DELAY_LINES> delayTimes{};
+        // FDN tank: 4, 8 or 16 lines processed as groups of four
+        FdnArena tank;
+        int fdnSize = 0; // index into FDN_LINE_OPTIONS, chosen from the menu
+        int delayInterpolation = 0; // 0: auto by response mode, else Interpolation + 1
+        int numLines = 0;
+        // Delay memory in use by process(). Replacements for new sample rates
+        // and line counts are built by the background thread.
+        DelayMemory* memory = nullptr;
+        dspext::SwapSlot<DelayMemory> memorySlot;
+        float_4 delayTimes[MAX_LINE_GROUPS];
         // Prime number-based delay multipliers for sparse FDN (less metallic resonances)
-        std::array<float, NUM_DELAY_LINES> baseMultipliers{0.37f, 0.53f, 0.73f, 0.97f};
-        std::array<float, NUM_DELAY_LINES> modScales{1.0f, -0.8f, 0.6f, -0.5f};
-
-        // Hadamard matrix for FDN (orthogonal mixing)
-        // H4 = [[1,1,1,1], [1,-1,1,-1], [1,1,-1,-1], [1,-1,-1,1]]
-        static constexpr float hadamard[NUM_DELAY_LINES][NUM_DELAY_LINES] = {
-                {0.5f,  0.5f,  0.5f,  0.5f},
-                {0.5f, -0.5f,  0.5f, -0.5f},
-                {0.5f,  0.5f, -0.5f, -0.5f},
-                {0.5f, -0.5f, -0.5f,  0.5f}
+        float_4 baseMultipliers[MAX_LINE_GROUPS];
+        float_4 modScales[MAX_LINE_GROUPS];
+        // Output taps. Lines 0-3 keep the original 4-line stereo pickup,
+        // extra lines are spread across L/R with alternating signs.
+        float_4 outWeightL[MAX_LINE_GROUPS];
+        float_4 outWeightR[MAX_LINE_GROUPS];
+
+        enum ReverbEngine {
+                ENGINE_FDN,
+                ENGINE_CONVOLUTION
         };
+        int reverbEngine = ENGINE_FDN;
+
+        // Convolution engine, built by the background thread
+        dspext::ConvolutionEngine* convolution = nullptr;
+        dspext::SwapSlot<dspext::ConvolutionEngine> convolutionSlot;
+
+        // Background thread for delay memory and IR loading
+        std::thread background;
+        std::mutex backgroundMutex;
+        std::condition_variable backgroundCV;
+        // Guarded by backgroundMutex
+        bool backgroundQuit = false;
+        bool memoryRequest = false;
+        float memoryRate = 0.f;
+        int memoryLines = 0;
+        // Background thread only, after construction
+        float builtRate = 0.f;
+        int builtLines = 0;
+        bool irRequest = false;
+        std::string irPath;
+        std::string irStatus = "(none)";
+        std::string memoryError;
+        float irSampleRate = 44100.f;
 
         PitchShifter shimmerL;
         PitchShifter shimmerR;
+        int shimmerInterval = 0; // index into SHIMMER_INTERVALS
+        int shimmerQuality = 0;  // 0: 40 ms grains, linear; 1: 80 ms grains, Hermite
 
         float sampleRate = 44100.f;
-        int bufferSize = 0;
+
+        // Sleep once the input is silent and the tank has stopped moving for
+        // longer than the engine can read back: its block mean square around
+        // the value at the start of each block stays under -120 dBFS. That
+        // is a decayed tail, or the constant that DST settles to, so while
+        // asleep the module passes the dry signal plus the held wet output.
+        static const int ENERGY_BLOCK = 64;
+        static constexpr float SILENCE_VOLTS = 5e-6f; // -120 dBFS at 5 V
+        // Per-line mean square for the same level inside the tank, where the
+        // output stage turns 1.0 into about 4 V
+        static constexpr float TAIL_FLOOR = 1.6e-12f;
+        float tailEnergy = 0.f;
+        int energyFrames = 0;
+        int quietFrames = 0;
+        bool asleep = false;
+        int sleepEngine = ENGINE_FDN;
+        float_4 settledFrame[MAX_LINE_GROUPS] = {};
+        float settledL = 0.f;
+        float settledR = 0.f;
+        float heldWetL = 0.f;
+        float heldWetR = 0.f;
 
         float lfoPhase = 0.f;
         float randomValue = 0.f;
@@ -210,24 +463,207 @@ struct Ahriman : Module {
                 configOutput(OUT_L_OUTPUT, "Left output");
                 configOutput(OUT_R_OUTPUT, "Right output");
 
-                onSampleRateChange();
+                // The first memory block is built here, before any process() call
+                sampleRate = APP->engine->getSampleRate();
+                builtRate = sampleRate;
+                builtLines = FDN_LINE_OPTIONS[fdnSize];
+                adoptMemory(new DelayMemory(builtRate, builtLines, PitchShifter::bufferLength(builtRate)));
+                background = std::thread(&Ahriman::backgroundLoop, this);
+
+        }
+
+        ~Ahriman() {
+                {
+                        std::lock_guard<std::mutex> lock(backgroundMutex);
+                        backgroundQuit = true;
+                }
+                // process() will not run again, so a pending publish need not wait for it
+                memorySlot.cancel();
+                convolutionSlot.cancel();
+                backgroundCV.notify_one();
+                if (background.joinable())
+                        background.join();
+                delete memory;
+                delete convolution;
+        }
+
+        // Asks the background thread for delay memory matching the current
+        // sample rate and line count
+        void requestMemory() {
+                {
+                        std::lock_guard<std::mutex> lock(backgroundMutex);
+                        memoryRequest = true;
+                        memoryRate = sampleRate;
+                        memoryLines = FDN_LINE_OPTIONS[fdnSize];
+                }
+                backgroundCV.notify_one();
+        }
+
+        void setFdnSize(int size) {
+                fdnSize = rack::math::clamp(size, 0, 2);
+                requestMemory();
+        }
+
+        // Points the tank and shimmer at a new memory block. Runs on the audio
+        // thread after a swap, so it only touches pointers and tables.
+        void adoptMemory(DelayMemory* newMemory) {
+                memory = newMemory;
+                tank.attach(memory->tank(), memory->lines, memory->tankLength);
+                configureTank(memory->lines);
+                shimmerL.attach(memory->sampleRate, memory->shimmer(0), memory->shimmerLength);
+                shimmerR.attach(memory->sampleRate, memory->shimmer(1), memory->shimmerLength);
+        }
+
+        // Queues an IR load at the current sample rate. Safe from any
+        // non-audio thread; an empty path reloads the current IR.
+        void requestIrLoad(const std::string& path) {
+                {
+                        std::lock_guard<std::mutex> lock(backgroundMutex);
+                        if (!path.empty())
+                                irPath = path;
+                        if (irPath.empty())
+                                return;
+                        irSampleRate = sampleRate;
+                        irRequest = true;
+                        irStatus = "loading...";
+                }
+                backgroundCV.notify_one();
+        }
+
+        std::string getIrStatus() {
+                std::lock_guard<std::mutex> lock(backgroundMutex);
+                return irStatus;
+        }
 
+        std::string getMemoryError() {
+                std::lock_guard<std::mutex> lock(backgroundMutex);
+                return memoryError;
+        }
+
+        void backgroundLoop() {
+                std::unique_lock<std::mutex> lock(backgroundMutex);
+                while (true) {
+                        backgroundCV.wait(lock, [&] { return backgroundQuit || memoryRequest || irRequest; });
+                        if (backgroundQuit)
+                                break;
+
+                        if (memoryRequest) {
+                                float rate = memoryRate;
+                                int lines = memoryLines;
+                                memoryRequest = false;
+                                if (rate == builtRate && lines == builtLines)
+                                        continue;
+                                lock.unlock();
+                                // The zero fill of up to tens of MB happens here, not in
+                                // process(). If it cannot be allocated the current block
+                                // stays in use; an exception must not escape this thread.
+                                DelayMemory* block = nullptr;
+                                try {
+                                        block = new DelayMemory(rate, lines, PitchShifter::bufferLength(rate));
+                                } catch (const std::bad_alloc&) {
+                                        WARN("Ahriman: out of memory for %d delay lines at %.0f Hz", lines, rate);
+                                }
+                                if (block) {
+                                        memorySlot.publish(block);
+                                        builtRate = rate;
+                                        builtLines = lines;
+                                }
+                                lock.lock();
+                                memoryError = block ? "" : "out of memory for " + std::to_string(lines) + " lines";
+                                continue;
+                        }
+
+                        std::string path = irPath;
+                        float rate = irSampleRate;
+                        irRequest = false;
+                        lock.unlock();
+
+                        // WAV decoding, resampling and partition FFTs all happen here
+                        std::vector<float> irL, irR;
+                        std::string error;
+                        dspext::ConvolutionEngine* engine = nullptr;
+                        try {
+                                if (dspext::loadImpulseResponse(path, rate, IR_MAX_SECONDS, irL, irR, error))
+                                        engine = new dspext::ConvolutionEngine(irL, irR);
+                        } catch (const std::bad_alloc&) {
+                                error = "out of memory";
+                        }
+                        if (engine)
+                                convolutionSlot.publish(engine);
+                        else
+                                WARN("Ahriman: failed to load IR %s: %s", path.c_str(), error.c_str());
+
+                        lock.lock();
+                        size_t slash = path.find_last_of("/\\");
+                        std::string name = (slash != std::string::npos) ? path.substr(slash + 1) : path;
+                        if (engine) {
+                                char seconds[16];
+                                snprintf(seconds, sizeof(seconds), "%.1f s", irL.size() / rate);
+                                irStatus = name + " (" + seconds + ")";
+                        } else {
+                                irStatus = name + ": " + error;
+                        }
+                }
         }
 
         void onSampleRateChange() override {
                 sampleRate = APP->engine->getSampleRate();
-                int required = (int)std::ceil(sampleRate * 3.5f) + 8;
-                if (required != bufferSize) {
-                        bufferSize = required;
-                        for (auto &line : delayLines) {
-                                line.init(bufferSize);
+                // Delay memory for the new rate is prepared off-thread; process()
+                // keeps running on the current block until it is swapped in
+                requestMemory();
+                // IRs are resampled at load time, so reload at the new rate
+                requestIrLoad("");
+        }
+
+        // Silences the wet path of a sleeping module, including the tone
+        // filter states that feed it on waking
+        void clearHeldWet() {
+                heldWetL = 0.f;
+                heldWetR = 0.f;
+                toneLowL = 0.f;
+                toneLowR = 0.f;
+                toneHighL = 0.f;
+                toneHighR = 0.f;
+        }
+
+        // Per-line tables for a line count
+        void configureTank(int lines) {
+                numLines = lines;
+                float extraWeight = numLines > 4 ? 0.3f / std::sqrt((float)(numLines - 4)) : 0.f;
+                for (int k = 0; k < MAX_LINE_GROUPS; ++k) {
+                        float mult[4], mod[4], wl[4], wr[4];
+                        for (int l = 0; l < 4; ++l) {
+                                int i = 4 * k + l;
+                                mult[l] = FDN_MULTIPLIERS[i];
+                                mod[l] = FDN_MOD_SCALES[i];
+                                wl[l] = (i % 2 == 0) ? extraWeight : -extraWeight;
+                                wr[l] = ((i / 2) % 2 == 0) ? extraWeight : -extraWeight;
                         }
+                        baseMultipliers[k] = float_4::load(mult);
+                        modScales[k] = float_4::load(mod);
+                        outWeightL[k] = float_4::load(wl);
+                        outWeightR[k] = float_4::load(wr);
+                        delayTimes[k] = memory->sampleRate * 0.1f * baseMultipliers[k];
                 }
-                for (size_t i = 0; i < delayTimes.size(); ++i) {
-                        delayTimes[i] = sampleRate * 0.1f * baseMultipliers[i];
+                outWeightL[0] = float_4(0.25f, 0.6f, 0.f, 0.15f);
+                outWeightR[0] = float_4(0.25f, 0.f, 0.6f, -0.15f);
+        }
+
+        // Feedback saturation of the DST mode for one line
+        static float shapeDistort(float content) {
+                // DISTORT: Aggressive saturation for gritty character
+                // Multiple stages of saturation for rich harmonic distortion
+                content = std::tanh(content * 2.8f);  // Heavy input drive
+                content = content * 0.85f;  // Scale back
+                // Second stage asymmetric distortion for character
+                if (content > 0.f) {
+                        content = std::tanh(content * 1.4f);
+                } else {
+                        content = std::tanh(content * 1.6f);  // Slightly more on negative
                 }
-                shimmerL.init(sampleRate);
-                shimmerR.init(sampleRate);
+                // Add subtle bit-crushing character for digital grunge
+                float crush = std::floor(content * 32.f) / 32.f;
+                return rack::math::crossfade(content, crush, 0.15f);
         }
 
         float getBipolarCv(Input &input) {
@@ -243,15 +679,6 @@ struct Ahriman : Module {
                 sampleRate = args.sampleRate;
 
                 float blend = rack::math::clamp(params[BLEND_PARAM].getValue() + getUnipolarCv(inputs[BLEND_CV_INPUT]), 0.f, 1.f);
-                float tone = rack::math::clamp(params[TONE_PARAM].getValue() + getBipolarCv(inputs[TONE_CV_INPUT]), -1.f, 1.f);
-                float regen = rack::math::clamp(params[REGEN_PARAM].getValue() + getUnipolarCv(inputs[REGEN_CV_INPUT]), 0.f, 1.f);
-                float speed = rack::math::clamp(params[SPEED_PARAM].getValue() + getUnipolarCv(inputs[SPEED_CV_INPUT]), 0.f, 1.f);
-                float index = rack::math::clamp(params[INDEX_PARAM].getValue() + getBipolarCv(inputs[INDEX_CV_INPUT]), -1.f, 1.f);
-                float size = rack::math::clamp(params[SIZE_PARAM].getValue() + getUnipolarCv(inputs[SIZE_CV_INPUT]), 0.f, 1.f);
-                float dense = rack::math::clamp(params[DENSE_PARAM].getValue() + getUnipolarCv(inputs[DENSE_CV_INPUT]), 0.f, 1.f);
-
-                int mode = (int)std::round(params[MODE_PARAM].getValue());
-                int response = (int)std::round(params[RESPONSE_PARAM].getValue());
                 bool fsu = params[FSU_PARAM].getValue() > 0.5f || inputs[FSU_GATE_INPUT].getVoltage() > 2.f;
 
                 lights[FSU_LIGHT].setSmoothBrightness(fsu ? 1.f : 0.f, args.sampleTime * 4.f);
@@ -276,6 +703,42 @@ struct Ahriman : Module {
                 float inL = inputs[IN_L_INPUT].getNormalVoltage(0.f);
                 float inR = inputs[IN_R_INPUT].isConnected() ? inputs[IN_R_INPUT].getVoltage() : inL;
 
+                // Input, FSU or an engine change wakes the module on this frame
+                bool inputSilent = std::fabs(inL) < SILENCE_VOLTS && std::fabs(inR) < SILENCE_VOLTS;
+                if (!inputSilent || fsu || reverbEngine != sleepEngine) {
+                        quietFrames = 0;
+                        asleep = false;
+                }
+                sleepEngine = reverbEngine;
+                if (asleep) {
+                        // Still pick up new memory or IRs so the background thread
+                        // is not left waiting. A new block or engine starts silent,
+                        // so the held output of the one in use drops to match and
+                        // waking does not step from a stale sample.
+                        bool swapped = false;
+                        if (memorySlot.take(memory)) {
+                                adoptMemory(memory);
+                                swapped |= reverbEngine == ENGINE_FDN;
+                        }
+                        if (convolutionSlot.take(convolution))
+                                swapped |= reverbEngine == ENGINE_CONVOLUTION;
+                        if (swapped)
+                                clearHeldWet();
+                        outputs[OUT_L_OUTPUT].setVoltage(rack::math::crossfade(inL, heldWetL, blend));
+                        outputs[OUT_R_OUTPUT].setVoltage(rack::math::crossfade(inR, heldWetR, blend));
+                        return;
+                }
+
+                float tone = rack::math::clamp(params[TONE_PARAM].getValue() + getBipolarCv(inputs[TONE_CV_INPUT]), -1.f, 1.f);
+                float regen = rack::math::clamp(params[REGEN_PARAM].getValue() + getUnipolarCv(inputs[REGEN_CV_INPUT]), 0.f, 1.f);
+                float speed = rack::math::clamp(params[SPEED_PARAM].getValue() + getUnipolarCv(inputs[SPEED_CV_INPUT]), 0.f, 1.f);
+                float index = rack::math::clamp(params[INDEX_PARAM].getValue() + getBipolarCv(inputs[INDEX_CV_INPUT]), -1.f, 1.f);
+                float size = rack::math::clamp(params[SIZE_PARAM].getValue() + getUnipolarCv(inputs[SIZE_CV_INPUT]), 0.f, 1.f);
+                float dense = rack::math::clamp(params[DENSE_PARAM].getValue() + getUnipolarCv(inputs[DENSE_CV_INPUT]), 0.f, 1.f);
+
+                int mode = (int)std::round(params[MODE_PARAM].getValue());
+                int response = (int)std::round(params[RESPONSE_PARAM].getValue());
+
                 float inSum = 0.5f * (inL + inR);
                 float inDiff = 0.5f * (inL - inR);
 
@@ -384,107 +847,138 @@ struct Ahriman : Module {
                         inputGain = 0.f;
                 }
 
-                // Read delay taps with modulation
-                std::array<float, NUM_DELAY_LINES> taps{};
-                for (int i = 0; i < NUM_DELAY_LINES; ++i) {
-                        float target = baseSamples * baseMultipliers[i];
-                        target *= rack::math::crossfade(0.6f, 1.5f, dense);
-                        float mod = modSignal * modSeconds * sampleRate * modScales[i];
-                        target = rack::math::clamp(target + mod, 8.f, (float)(bufferSize - 8));
-
-                        // Response modes: BND (smooth), LRP (interpolated), JMP (instant)
-                        if (response == 2) {
-                                delayTimes[i] = target;  // JMP: instant jumps
-                        } else {
-                                delayTimes[i] += (target - delayTimes[i]) * smoothing;
+                if (memorySlot.take(memory))
+                        adoptMemory(memory);
+                convolutionSlot.take(convolution);
+
+                float wetL = 0.f;
+                float wetR = 0.f;
+                // Frames of quiet needed before sleeping: everything the engine
+                // can still read back must have been written during the quiet
+                int tailSpan = 0;
+                if (reverbEngine == ENGINE_CONVOLUTION && convolution) {
+                        // Impulse response: SIZE scales the late tail (past ~85 ms
+                        // at 48 kHz), unity at the default setting
+                        float earlyL, earlyR, lateL, lateR;
+                        convolution->process(inL * 0.2f, inR * 0.2f, earlyL, earlyR, lateL, lateR);
+                        float lateGain = 2.f * size;
+                        wetL = earlyL + lateGain * lateL;
+                        wetR = earlyR + lateGain * lateR;
+                        if (energyFrames == 0) {
+                                settledL = wetL;
+                                settledR = wetR;
                         }
-                        taps[i] = delayLines[i].read(delayTimes[i]);
-                }
-
-                // Apply Hadamard matrix mixing (FDN feedback matrix)
-                std::array<float, NUM_DELAY_LINES> mixed{};
-                for (int i = 0; i < NUM_DELAY_LINES; ++i) {
-                        mixed[i] = 0.f;
-                        for (int j = 0; j < NUM_DELAY_LINES; ++j) {
-                                mixed[i] += hadamard[i][j] * taps[j];
+                        float devL = wetL - settledL;
+                        float devR = wetR - settledR;
+                        tailEnergy += 0.5f * (devL * devL + devR * devR);
+                        tailSpan = convolution->getLength();
+                } else {
+                        int groups = numLines / 4;
+
+                        // Read delay taps with modulation, four lines per batch
+                        float sizeScale = rack::math::crossfade(0.6f, 1.5f, dense);
+                        float modSamples = modSignal * modSeconds * sampleRate;
+                        float maxDelay = (float)memory->maxDelay;
+                        Interpolation interp = (Interpolation)(delayInterpolation - 1);
+                        if (delayInterpolation == 0) {
+                                // Auto: BND glides slowly enough for linear taps
+                                interp = (response == 0) ? INTERP_LINEAR : INTERP_HERMITE;
                         }
-                }
-
-                // Stereo output derived from FDN
-                float wetL = mixed[1] * 0.6f + mixed[0] * 0.25f + mixed[3] * 0.15f;
-                float wetR = mixed[2] * 0.6f + mixed[0] * 0.25f - mixed[3] * 0.15f;
-
-                // Shimmer mode: octave-up pitch shift with feedback
-                float shimmerOutL = 0.f;
-                float shimmerOutR = 0.f;
-                if (mode == 2) {
-                        // Feed reverb output into pitch shifter
-                        shimmerL.write(wetL);
-                        shimmerR.write(wetR);
-
-                        // Get octave-up shifted output
-                        shimmerOutL = shimmerL.processOctaveUp(sampleRate);
-                        shimmerOutR = shimmerR.processOctaveUp(sampleRate);
-
-                        // Enhanced shimmer blend for MORE DEMONIC character
-                        // Add subtle detuning for richer, more otherworldly sound
-                        float shimmerEnhanced = 0.5f;  // More shimmer in the mix
-                        wetL = rack::math::crossfade(wetL, shimmerOutL, shimmerEnhanced);
-                        wetR = rack::math::crossfade(wetR, shimmerOutR, shimmerEnhanced);
-
-                        // Add slight stereo width to shimmer for spatial enhancement
-                        float stereoSpread = (wetL - wetR) * 0.2f;
-                        wetL += stereoSpread;
-                        wetR -= stereoSpread;
-                }
-
-                // FDN feedback with nonlinear processing per delay line
-                for (int i = 0; i < NUM_DELAY_LINES; ++i) {
-                        float content = mixed[i];
-
-                        // Enhanced NODE MODE with much more distinctive character
-                        if (mode == 0) {
-                                // LIMIT: Clean reverb with transparent hard limiting
-                                // Very subtle compression, pristine and clean
-                                content = rack::math::clamp(content, -1.25f, 1.25f);
-
-                        } else if (mode == 1) {
-                                // DISTORT: Aggressive saturation for gritty character
-                                // Multiple stages of saturation for rich harmonic distortion
-                                content = std::tanh(content * 2.8f);  // Heavy input drive
-                                content = content * 0.85f;  // Scale back
-                                // Second stage asymmetric distortion for character
-                                if (content > 0.f) {
-                                        content = std::tanh(content * 1.4f);
+                        float_4 mixed[MAX_LINE_GROUPS];
+                        for (int k = 0; k < groups; ++k) {
+                                float_4 target = baseSamples * sizeScale * baseMultipliers[k];
+                                target = simd::clamp(target + modSamples * modScales[k], 8.f, maxDelay);
+
+                                // Response modes: BND (smooth), LRP (interpolated), JMP (instant)
+                                if (response == 2) {
+                                        delayTimes[k] = target;  // JMP: instant jumps
                                 } else {
-                                        content = std::tanh(content * 1.6f);  // Slightly more on negative
+                                        delayTimes[k] += (target - delayTimes[k]) * smoothing;
                                 }
-                                // Add subtle bit-crushing character for digital grunge
-                                float crush = std::floor(content * 32.f) / 32.f;
-                                content = rack::math::crossfade(content, crush, 0.15f);
+                        }
+                        tank.readAll(delayTimes, mixed, interp);
 
-                        } else {
-                                // SHIFT: Demonic pitch-shifting - much more prominent
-                                // Lighter saturation to preserve pitch shift clarity
-                                content = std::tanh(content * 1.1f);
+                        // Hadamard mixing (FDN feedback matrix)
+                        hadamardMix(mixed, groups);
+
+                        // Stereo output derived from FDN
+                        float_4 sumL = 0.f;
+                        float_4 sumR = 0.f;
+                        for (int k = 0; k < groups; ++k) {
+                                sumL += mixed[k] * outWeightL[k];
+                                sumR += mixed[k] * outWeightR[k];
                         }
+                        wetL = horizontalSum(sumL);
+                        wetR = horizontalSum(sumR);
 
-                        // Stereo input injection
-                        float stereoSpread = (i % 2 == 0) ? 1.f : -1.f;
-                        float injection = inputGain * (inSum * 0.7f + inDiff * stereoSpread * 0.3f);
+                        // Shimmer mode: octave-up pitch shift with feedback
+                        float shimmerOutL = 0.f;
+                        float shimmerOutR = 0.f;
+                        if (mode == 2) {
+                                // Feed reverb output into pitch shifter
+                                shimmerL.write(wetL);
+                                shimmerR.write(wetR);
+
+                                // Get pitch-shifted output
+                                shimmerL.configure(SHIMMER_INTERVALS[shimmerInterval], shimmerQuality == 1);
+                                shimmerR.configure(SHIMMER_INTERVALS[shimmerInterval], shimmerQuality == 1);
+                                shimmerOutL = shimmerL.process();
+                                shimmerOutR = shimmerR.process();
+
+                                // Enhanced shimmer blend for MORE DEMONIC character
+                                // Add subtle detuning for richer, more otherworldly sound
+                                float shimmerEnhanced = 0.5f;  // More shimmer in the mix
+                                wetL = rack::math::crossfade(wetL, shimmerOutL, shimmerEnhanced);
+                                wetR = rack::math::crossfade(wetR, shimmerOutR, shimmerEnhanced);
+
+                                // Add slight stereo width to shimmer for spatial enhancement
+                                float stereoSpread = (wetL - wetR) * 0.2f;
+                                wetL += stereoSpread;
+                                wetR -= stereoSpread;
+                        }
 
-                        // Shimmer mode: feed pitch-shifted signal back into tank with MORE INTENSITY
+                        // FDN feedback with nonlinear processing per delay line
+                        // Stereo input injection alternates sign across lines, and in
+                        // shimmer mode even lines take the left shimmer, odd the right
+                        const float_4 stereoSpread(1.f, -1.f, 1.f, -1.f);
+                        float_4 injection = inputGain * (inSum * 0.7f + inDiff * stereoSpread * 0.3f);
                         if (mode == 2) {
-                                float shimmerFeed = (i % 2 == 0) ? shimmerOutL : shimmerOutR;
                                 // Increased shimmer feedback for more demonic, otherworldly character
-                                injection += 0.55f * shimmerFeed;
+                                injection += 0.55f * float_4(shimmerOutL, shimmerOutR, shimmerOutL, shimmerOutR);
                         }
 
-                        // Write to delay line with feedback and dense control
-                        float writeSample = injection + feedback * content * denseShape;
-                        delayLines[i].write(writeSample);
+                        float_4 writeFrame[MAX_LINE_GROUPS];
+                        float_4 motion = 0.f;
+                        for (int k = 0; k < groups; ++k) {
+                                float_4 content = mixed[k];
+
+                                // Enhanced NODE MODE with much more distinctive character
+                                if (mode == 0) {
+                                        // LIMIT: Clean reverb with transparent hard limiting
+                                        // Very subtle compression, pristine and clean
+                                        content = simd::clamp(content, -1.25f, 1.25f);
+                                } else if (mode == 2) {
+                                        // SHIFT: Demonic pitch-shifting - much more prominent
+                                        // Lighter saturation to preserve pitch shift clarity
+                                        content = tanhExp(content * 1.1f);
+                                } else {
+                                        for (int l = 0; l < 4; ++l)
+                                                content[l] = shapeDistort(content[l]);
+                                }
+
+                                // Write to delay line with feedback and dense control
+                                writeFrame[k] = injection + feedback * content * denseShape;
+                                if (energyFrames == 0)
+                                        settledFrame[k] = writeFrame[k];
+                                float_4 dev = writeFrame[k] - settledFrame[k];
+                                motion += dev * dev;
+                        }
+                        tank.write(writeFrame);
+                        tailEnergy += horizontalSum(motion) / numLines;
+                        tailSpan = memory->maxDelay + 8;
                 }
 
+
                 auto toneProcess = [&](float &sample, float &lowState, float &highState) {
                         // Bipolar control: left = lowpass, right = highpass, center = disabled
                         float amount = std::abs(tone);
@@ -510,18 +1004,71 @@ struct Ahriman : Module {
                         }
                 };
 
+                bool sleepNow = false;
+                if (++energyFrames == ENERGY_BLOCK) {
+                        bool quiet = inputSilent && tailEnergy < TAIL_FLOOR * ENERGY_BLOCK;
+                        quietFrames = quiet ? quietFrames + ENERGY_BLOCK : 0;
+                        tailEnergy = 0.f;
+                        energyFrames = 0;
+                        sleepNow = quietFrames > tailSpan;
+                }
+
                 toneProcess(wetL, toneLowL, toneHighL);
                 toneProcess(wetR, toneLowR, toneHighR);
 
                 wetL = std::tanh(wetL * 0.8f) * 5.f;
                 wetR = std::tanh(wetR * 0.8f) * 5.f;
 
+                if (sleepNow) {
+                        asleep = true;
+                        heldWetL = wetL;
+                        heldWetR = wetR;
+                }
+
                 float outL = rack::math::crossfade(inL, wetL, blend);
                 float outR = rack::math::crossfade(inR, wetR, blend);
 
                 outputs[OUT_L_OUTPUT].setVoltage(outL);
                 outputs[OUT_R_OUTPUT].setVoltage(outR);
         }
+
+        json_t* dataToJson() override {
+                json_t* root = json_object();
+                json_object_set_new(root, "fdnSize", json_integer(fdnSize));
+                json_object_set_new(root, "delayInterpolation", json_integer(delayInterpolation));
+                json_object_set_new(root, "reverbEngine", json_integer(reverbEngine));
+                json_object_set_new(root, "shimmerInterval", json_integer(shimmerInterval));
+                json_object_set_new(root, "shimmerQuality", json_integer(shimmerQuality));
+                std::string path;
+                {
+                        std::lock_guard<std::mutex> lock(backgroundMutex);
+                        path = irPath;
+                }
+                if (!path.empty())
+                        json_object_set_new(root, "irPath", json_string(path.c_str()));
+                return root;
+        }
+
+        void dataFromJson(json_t* root) override {
+                json_t* sizeJ = json_object_get(root, "fdnSize");
+                if (sizeJ)
+                        setFdnSize((int)json_integer_value(sizeJ));
+                json_t* interpJ = json_object_get(root, "delayInterpolation");
+                if (interpJ)
+                        delayInterpolation = rack::math::clamp((int)json_integer_value(interpJ), 0, (int)INTERP_LEN);
+                json_t* engineJ = json_object_get(root, "reverbEngine");
+                if (engineJ)
+                        reverbEngine = rack::math::clamp((int)json_integer_value(engineJ), 0, 1);
+                json_t* intervalJ = json_object_get(root, "shimmerInterval");
+                if (intervalJ)
+                        shimmerInterval = rack::math::clamp((int)json_integer_value(intervalJ), 0, 3);
+                json_t* qualityJ = json_object_get(root, "shimmerQuality");
+                if (qualityJ)
+                        shimmerQuality = rack::math::clamp((int)json_integer_value(qualityJ), 0, 1);
+                json_t* irJ = json_object_get(root, "irPath");
+                if (irJ && json_is_string(irJ))
+                        requestIrLoad(json_string_value(irJ));
+        }
 };
 
 struct BackgroundImage : Widget {
@@ -631,6 +1178,54 @@ struct AhrimanWidget : ModuleWidget {
                 addOutput(createOutputCentered<DarkPJ301MPort>(mm2px(Vec(33.3, 119.0)), module, Ahriman::OUT_L_OUTPUT));
                 addOutput(createOutputCentered<DarkPJ301MPort>(mm2px(Vec(42.3, 119.0)), module, Ahriman::OUT_R_OUTPUT));
         }
+
+        void appendContextMenu(Menu* menu) override {
+                Ahriman* module = getModule<Ahriman>();
+                if (!module)
+                        return;
+
+                menu->addChild(new MenuSeparator());
+                std::string memoryError = module->getMemoryError();
+                if (!memoryError.empty())
+                        menu->addChild(createMenuLabel("Delay memory: " + memoryError));
+                menu->addChild(createIndexSubmenuItem("Delay lines",
+                        {"4", "8 (denser)", "16 (densest)"},
+                        [=]() { return module->fdnSize; },
+                        [=](int size) { module->setFdnSize(size); }
+                ));
+                menu->addChild(createIndexPtrSubmenuItem("Delay interpolation",
+                        {"Auto (linear for BND, Hermite otherwise)",
+                         "Linear (1x CPU, 2 reads/line)",
+                         "Hermite (~1.1x CPU, 4 reads/line)",
+                         "Allpass (~1.2x CPU, 2 reads/line + feedback)"},
+                        &module->delayInterpolation
+                ));
+                menu->addChild(createIndexPtrSubmenuItem("Shimmer interval",
+                        {"+12 (octave up)", "-12 (octave down)", "+7 (fifth up)", "+19 (octave and fifth up)"},
+                        &module->shimmerInterval
+                ));
+                menu->addChild(createIndexPtrSubmenuItem("Shimmer quality",
+                        {"Standard", "High (long grains, Hermite)"},
+                        &module->shimmerQuality
+                ));
+
+                menu->addChild(new MenuSeparator());
+                menu->addChild(createIndexPtrSubmenuItem("Reverb engine",
+                        {"Algorithmic (FDN)", "Convolution (IR)"},
+                        &module->reverbEngine
+                ));
+                menu->addChild(createMenuLabel("IR: " + module->getIrStatus()));
+                menu->addChild(createMenuItem("Load impulse response (WAV)", "", [=]() {
+                        osdialog_filters* filters = osdialog_filters_parse("WAV file:wav");
+                        char* path = osdialog_file(OSDIALOG_OPEN, nullptr, nullptr, filters);
+                        osdialog_filters_free(filters);
+                        if (path) {
+                                module->requestIrLoad(path);
+                                module->reverbEngine = Ahriman::ENGINE_CONVOLUTION;
+                                free(path);
+                        }
+                }));
+        }
 };
 
 Model *modelAhriman = createModel<Ahriman, AhrimanWidget>("Ahriman");
@@ -1,20 +1,122 @@
 #include "plugin.hpp"
 #include "dsp/dsp.hpp"
+#include "dsp/Convolver.hpp"
+#include "dsp/SwapSlot.hpp"
+#include "dsp/Wav.hpp"
+#include <osdialog.h>
 #include <cmath>
 #include <algorithm>
 #include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
 #include <vector>
 
 using namespace rack;
 
 namespace {
-struct BitTableOsc {
-        static constexpr int tableSize = 256;
+using simd::float_4;
+
+// One set of band-limited single-cycle waves, immutable once built. Each
+// frame has `levels` mip levels of tableSize samples plus a wrap-around
+// guard sample; level k keeps the first (sourceSize / 2) >> k harmonics of
+// the frame's sourceSize-sample cycle, never its Nyquist bin.
+struct WaveTableSet {
+        int frames;
+        int sourceSize;
+        int tableSize;
+        int levels;
+        std::vector<float> data;
+
+        WaveTableSet(int frames, int sourceSize, int tableSize, int levels)
+                : frames(frames), sourceSize(sourceSize), tableSize(tableSize), levels(levels),
+                  data((size_t)frames * levels * (tableSize + 1)) {}
+
+        const float* table(int frame, int level) const {
+                return data.data() + ((size_t)frame * levels + level) * (tableSize + 1);
+        }
+
+        float* table(int frame, int level) {
+                return data.data() + ((size_t)frame * levels + level) * (tableSize + 1);
+        }
+};
+
+// Fills the mip levels of one frame: each level truncates the source
+// spectrum and resynthesizes it at tableSize through a zero-padded
+// inverse FFT
+class MipBuilder {
+public:
+        MipBuilder(int sourceSize, int tableSize) : sourceSize(sourceSize), tableSize(tableSize) {
+                sourceSetup = pffft_new_setup(sourceSize, PFFFT_REAL);
+                tableSetup = pffft_new_setup(tableSize, PFFFT_REAL);
+                source.resize(sourceSize);
+                spectrum.resize(sourceSize);
+                level.resize(tableSize);
+                work.resize(std::max(sourceSize, tableSize));
+        }
+
+        ~MipBuilder() {
+                pffft_destroy_setup(sourceSetup);
+                pffft_destroy_setup(tableSetup);
+        }
+
+        MipBuilder(const MipBuilder&) = delete;
+        MipBuilder& operator=(const MipBuilder&) = delete;
+
+        void build(WaveTableSet& set, int frame, const float* cycle, bool removeDc) {
+                std::copy(cycle, cycle + sourceSize, source.data);
+                pffft_transform_ordered(sourceSetup, source.data, spectrum.data, work.data, PFFFT_FORWARD);
+                for (int k = 0; k < set.levels; ++k) {
+                        // Ordered layout: DC, Nyquist, then re/im per bin
+                        int harmonics = std::min((sourceSize / 2) >> k, sourceSize / 2 - 1);
+                        level.zero();
+                        level.data[0] = removeDc ? 0.f : spectrum.data[0];
+                        for (int h = 1; h <= harmonics; ++h) {
+                                level.data[2 * h] = spectrum.data[2 * h];
+                                level.data[2 * h + 1] = spectrum.data[2 * h + 1];
+                        }
+                        float* out = set.table(frame, k);
+                        pffft_transform_ordered(tableSetup, level.data, out, work.data, PFFFT_BACKWARD);
+                        for (int i = 0; i < tableSize; ++i)
+                                out[i] *= 1.f / sourceSize;
+                        out[tableSize] = out[0];
+                }
+        }
+
+private:
+        int sourceSize;
+        int tableSize;
+        PFFFT_Setup* sourceSetup;
+        PFFFT_Setup* tableSetup;
+        dspext::AlignedFloats source, spectrum, level, work;
+};
+
+// Band-limited copies of the built-in BitTableOsc wavetables, one set per
+// mode, built once per process and shared read-only by every instance.
+// Sources are 256 samples, stored at 1024 so linear interpolation adds
+// little error.
+struct BitTableStore {
+        static constexpr int sourceSize = 256;
+        static constexpr int tableSize = 1024;
+        static constexpr int modes = 3;
         static constexpr int wavesPerMode = 8;
+        static constexpr int levels = 8;
 
-        std::array<std::array<std::array<float, tableSize>, wavesPerMode>, 3> tables{};
-        bool initialised = false;
-        float phase = 0.f;
+        const WaveTableSet& mode(int m) const {
+                return sets[m];
+        }
+
+        static const BitTableStore& get() {
+                static const BitTableStore instance;
+                return instance;
+        }
+
+private:
+        std::vector<WaveTableSet> sets;
 
         static uint32_t lfsrStep(uint32_t state, uint32_t taps) {
                 uint32_t lsb = state & 1u;
@@ -24,196 +126,385 @@ struct BitTableOsc {
                 return state ? state : 1u;
         }
 
-        void initTables() {
-                if (initialised)
-                        return;
-
-                // Mode 0: LFSR - linear feedback shift register patterns
-                constexpr uint32_t lfsrTapMask = 0xD0000001u;
-                constexpr std::array<uint32_t, wavesPerMode> seeds = {
-                        0x13579BDFu, 0x2468ACE1u, 0x89ABCDEFu, 0x10293847u,
-                        0x55667788u, 0xABCDEF12u, 0x1F2E3D4Cu, 0x0C0FFEE0u};
-
-                for (size_t wave = 0; wave < wavesPerMode; ++wave) {
-                        uint32_t state = seeds[wave];
-                        float integrator = 0.f;
-                        float norm = 0.f;
-                        for (int i = 0; i < tableSize; ++i) {
-                                state = lfsrStep(state, lfsrTapMask);
-                                float bit = (state & 1u) ? 1.f : -1.f;
-                                float nibble = static_cast<float>((state >> 1) & 0x7u) / 3.5f - 1.f;
-                                float step = 0.55f * bit + 0.45f * nibble;
-                                integrator = 0.82f * integrator + 0.18f * step;
-                                tables[0][wave][i] = integrator;
-                                norm = std::max(norm, std::fabs(integrator));
+        static void buildSource(int mode, int wave, float* out) {
+                switch (mode) {
+                        // Mode 0: LFSR - linear feedback shift register patterns
+                        case 0: {
+                                constexpr uint32_t lfsrTapMask = 0xD0000001u;
+                                constexpr std::array<uint32_t, wavesPerMode> seeds = {
+                                        0x13579BDFu, 0x2468ACE1u, 0x89ABCDEFu, 0x10293847u,
+                                        0x55667788u, 0xABCDEF12u, 0x1F2E3D4Cu, 0x0C0FFEE0u};
+                                uint32_t state = seeds[wave];
+                                float integrator = 0.f;
+                                float norm = 0.f;
+                                for (int i = 0; i < sourceSize; ++i) {
+                                        state = lfsrStep(state, lfsrTapMask);
+                                        float bit = (state & 1u) ? 1.f : -1.f;
+                                        float nibble = static_cast<float>((state >> 1) & 0x7u) / 3.5f - 1.f;
+                                        float step = 0.55f * bit + 0.45f * nibble;
+                                        integrator = 0.82f * integrator + 0.18f * step;
+                                        out[i] = integrator;
+                                        norm = std::max(norm, std::fabs(integrator));
+                                }
+                                if (norm < 1e-3f)
+                                        norm = 1.f;
+                                for (int i = 0; i < sourceSize; ++i)
+                                        out[i] /= norm;
+                                break;
+                        }
+                        // Mode 1: SQR - square wave AM'd by harmonic series
+                        // Each waveform blends between different harmonics
+                        case 1: {
+                                int harmonic = wave + 1; // Harmonics 1-8
+                                for (int i = 0; i < sourceSize; ++i) {
+                                        float phase = static_cast<float>(i) / static_cast<float>(sourceSize);
+                                        float square = phase < 0.5f ? 1.f : -1.f;
+                                        float modulator = std::sin(2.f * M_PI * phase * harmonic);
+                                        out[i] = square * (0.5f + 0.5f * modulator);
+                                }
+                                break;
+                        }
+                        // Mode 2: SQR2 - like SQR but modulating pitch jumps octave per waveform
+                        default: {
+                                float modFreq = std::pow(2.f, static_cast<float>(wave)); // 0-7 octaves
+                                for (int i = 0; i < sourceSize; ++i) {
+                                        float phase = static_cast<float>(i) / static_cast<float>(sourceSize);
+                                        float square = phase < 0.5f ? 1.f : -1.f;
+                                        float modPhase = phase * modFreq;
+                                        modPhase -= std::floor(modPhase);
+                                        float modulator = std::sin(2.f * M_PI * modPhase);
+                                        out[i] = square * (0.5f + 0.5f * modulator);
+                                }
+                                break;
                         }
-                        if (norm < 1e-3f)
-                                norm = 1.f;
-                        for (float& sample : tables[0][wave])
-                                sample /= norm;
                 }
+        }
 
-                // Mode 1: SQR - square wave AM'd by harmonic series
-                // Each waveform blends between different harmonics
-                for (size_t wave = 0; wave < wavesPerMode; ++wave) {
-                        int harmonic = static_cast<int>(wave) + 1; // Harmonics 1-8
-                        for (int i = 0; i < tableSize; ++i) {
-                                float phase = static_cast<float>(i) / static_cast<float>(tableSize);
-                                float square = phase < 0.5f ? 1.f : -1.f;
-                                float modulator = std::sin(2.f * M_PI * phase * harmonic);
-                                tables[1][wave][i] = square * (0.5f + 0.5f * modulator);
+        BitTableStore() {
+                MipBuilder builder(sourceSize, tableSize);
+                std::vector<float> source(sourceSize);
+                sets.reserve(modes);
+                for (int m = 0; m < modes; ++m) {
+                        sets.emplace_back(wavesPerMode, sourceSize, tableSize, levels);
+                        for (int wave = 0; wave < wavesPerMode; ++wave) {
+                                buildSource(m, wave, source.data());
+                                builder.build(sets.back(), wave, source.data(), false);
                         }
                 }
+        }
+};
 
-                // Mode 2: SQR2 - like SQR but modulating pitch jumps octave per waveform
-                for (size_t wave = 0; wave < wavesPerMode; ++wave) {
-                        int octaveShift = static_cast<int>(wave); // 0-7 octaves
-                        float modFreq = std::pow(2.f, static_cast<float>(octaveShift));
-                        for (int i = 0; i < tableSize; ++i) {
-                                float phase = static_cast<float>(i) / static_cast<float>(tableSize);
-                                float square = phase < 0.5f ? 1.f : -1.f;
-                                float modPhase = phase * modFreq;
-                                modPhase -= std::floor(modPhase);
-                                float modulator = std::sin(2.f * M_PI * modPhase);
-                                tables[2][wave][i] = square * (0.5f + 0.5f * modulator);
+// Imported Serum/Vital-style wavetables: single cycles of frameSize
+// samples back to back, or one shorter cycle that is resampled to
+// frameSize. Sets are analyzed off the audio thread and cached by a hash of
+// the file contents, so every instance that loads the same table shares
+// one copy for as long as any of them holds it.
+struct UserWavetables {
+        static constexpr int frameSize = 2048;
+        static constexpr int maxFrames = 256;
+        static constexpr int levels = 11; // down to the fundamental alone
+        // Generous for maxFrames of multichannel 32-bit audio
+        static constexpr size_t maxFileBytes = 64u << 20;
+
+        static UserWavetables& get() {
+                static UserWavetables instance;
+                return instance;
+        }
+
+        // Loader threads only. Returns null with a message in error.
+        std::shared_ptr<const WaveTableSet> load(const std::string& path, std::string& error) {
+                std::vector<uint8_t> bytes;
+                if (!dspext::readFileBytes(path, maxFileBytes, bytes, error))
+                        return nullptr;
+                uint64_t key = hash(bytes);
+                {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        auto it = cache.find(key);
+                        if (it != cache.end()) {
+                                if (std::shared_ptr<const WaveTableSet> set = it->second.lock())
+                                        return set;
                         }
                 }
 
-                initialised = true;
+                // Frames past the table are never decoded
+                dspext::WavInfo info;
+                if (!dspext::readWavInfo(bytes, info, error))
+                        return nullptr;
+                std::vector<float> channels[1];
+                dspext::decodeWav(bytes, info, 1, maxFrames * frameSize, channels);
+                std::shared_ptr<const WaveTableSet> set = analyze(channels[0], error);
+                if (!set)
+                        return nullptr;
+
+                // Another instance may have analyzed the same file meanwhile
+                std::lock_guard<std::mutex> lock(mutex);
+                for (auto it = cache.begin(); it != cache.end();)
+                        it = it->second.expired() ? cache.erase(it) : std::next(it);
+                std::weak_ptr<const WaveTableSet>& entry = cache[key];
+                if (std::shared_ptr<const WaveTableSet> existing = entry.lock())
+                        return existing;
+                entry = set;
+                return set;
         }
 
-        void reset(float position = 0.f) {
-                phase = position - std::floor(position);
+private:
+        std::mutex mutex;
+        std::map<uint64_t, std::weak_ptr<const WaveTableSet>> cache;
+
+        // 64-bit FNV-1a
+        static uint64_t hash(const std::vector<uint8_t>& bytes) {
+                uint64_t h = 0xCBF29CE484222325ull;
+                for (uint8_t b : bytes) {
+                        h ^= b;
+                        h *= 0x100000001B3ull;
+                }
+                return h;
         }
 
-        float process(float freq, float wave, float shape, float timeMod, int mode, float sampleRate, bool sync) {
-                initTables();
-                mode = rack::math::clamp(mode, 0, static_cast<int>(tables.size()) - 1);
-                float dt = freq / sampleRate;
-                dt = rack::math::clamp(dt, 1e-5f, 0.5f);
-                if (sync)
-                        phase = 0.f;
+        // DC is removed from every frame and the whole table is normalized to
+        // a unit peak, keeping the level differences between frames
+        static std::shared_ptr<const WaveTableSet> analyze(const std::vector<float>& samples, std::string& error) {
+                int length = (int)samples.size();
+                int frames = std::min(length / frameSize, maxFrames);
+                std::vector<float> cycle(frameSize);
+                if (frames == 0) {
+                        if (length < 2) {
+                                error = "WAV file is too short";
+                                return nullptr;
+                        }
+                        // Periodic linear resampling of one short cycle
+                        frames = 1;
+                        for (int i = 0; i < frameSize; ++i) {
+                                float t = (float)i * length / frameSize;
+                                int i0 = std::min((int)t, length - 1);
+                                int i1 = i0 + 1 < length ? i0 + 1 : 0;
+                                cycle[i] = samples[i0] + (t - i0) * (samples[i1] - samples[i0]);
+                        }
+                }
 
-                float warp = (timeMod - 0.5f) * 1.1f;
-                float curvature = 1.f + warp * std::sin(2.f * M_PI * phase);
-                float phaseStep = dt * rack::math::clamp(curvature, 0.2f, 1.8f);
-                phase += phaseStep;
-                phase -= std::floor(phase);
+                std::shared_ptr<WaveTableSet> set = std::make_shared<WaveTableSet>(frames, frameSize, frameSize, levels);
+                MipBuilder builder(frameSize, frameSize);
+                for (int f = 0; f < frames; ++f) {
+                        const float* source = cycle.data();
+                        if (length >= frameSize)
+                                source = samples.data() + (size_t)f * frameSize;
+                        builder.build(*set, f, source, true);
+                }
 
-                float idx = phase * tableSize;
-                int indexA = static_cast<int>(idx) % tableSize;
-                int indexB = (indexA + 1) % tableSize;
-                float frac = idx - std::floor(idx);
+                float peak = 0.f;
+                for (int f = 0; f < frames; ++f) {
+                        const float* table = set->table(f, 0);
+                        for (int i = 0; i < frameSize; ++i)
+                                peak = std::max(peak, std::fabs(table[i]));
+                }
+                if (peak < 1e-6f) {
+                        error = "WAV file is silent";
+                        return nullptr;
+                }
+                for (float& v : set->data)
+                        v /= peak;
+                return set;
+        }
+};
 
-                const auto& modeTables = tables[mode];
+// A user wavetable as held by one instance. Swapped in whole, so the
+// reference it drops is released on the loader thread.
+struct LoadedWavetable {
+        std::shared_ptr<const WaveTableSet> set;
+};
 
-                // Waveform parameter selects which waveform in the table (0-7)
+// log2 from the exponent bits plus a quadratic fit of the mantissa, within
+// 0.005 of log2. The fit stays inside [0, 1), so the integer part, which
+// mip selection relies on, is always exact.
+inline float_4 fastLog2(float_4 x) {
+        simd::int32_4 bits = simd::int32_4::cast(x);
+        float_4 exponent = float_4(((bits >> 23) & simd::int32_4(0xFF)) - simd::int32_4(127));
+        float_4 m = float_4::cast((bits & simd::int32_4(0x007FFFFF)) | simd::int32_4(0x3F800000));
+        return exponent + (-0.34484843f * m + 2.02466578f) * m - 1.67487759f;
+}
+
+// Four voices of the table oscillator, one per lane
+struct BitTableOsc4 {
+        float_4 phase = 0.f;
+
+        // dt is the frequency in cycles per sample
+        float_4 process(float_4 dt, float_4 wave, float_4 shape, float_4 timeMod, const WaveTableSet& set, float_4 sync) {
+                dt = simd::clamp(dt, 1e-5f, 0.5f);
+                phase = simd::ifelse(sync, 0.f, phase);
+
+                float_4 warp = (timeMod - 0.5f) * 1.1f;
+                float_4 curvature = 1.f + warp * sin2pi(phase);
+                float_4 phaseStep = dt * simd::clamp(curvature, 0.2f, 1.8f);
+                phase += phaseStep;
+                phase -= simd::floor(phase);
+
+                // Level k holds harmonics up to (sourceSize / 2) / 2^k, below
+                // Nyquist once 2^k >= sourceSize * phaseStep. Levels floor(p)
+                // and floor(p) + 1 with p = log2(2 * sourceSize * phaseStep)
+                // both qualify and are crossfaded.
+                float_4 levelPos = fastLog2(2.f * set.sourceSize * phaseStep);
+                levelPos = simd::clamp(levelPos, 0.f, set.levels - 1.f);
+                float_4 level = simd::fmin(simd::floor(levelPos), set.levels - 2.f);
+                float_4 levelFrac = levelPos - level;
+
+                float_4 idx = phase * (float)set.tableSize;
+                float_4 index = simd::fmin(simd::floor(idx), set.tableSize - 1.f);
+                float_4 frac = idx - index;
+
+                // Waveform parameter selects which waveform in the table
                 // Shape parameter controls interpolation/morphing between adjacent waveforms
-                float tableIndex = rack::math::clamp(wave, 0.f, 0.999f) * (wavesPerMode - 1);
-                int baseWave = static_cast<int>(std::floor(tableIndex));
-                int nextWave = rack::math::clamp(baseWave + 1, 0, wavesPerMode - 1);
+                float_4 tableIndex = simd::clamp(wave, 0.f, 0.999f) * (float)(set.frames - 1);
+                float_4 baseWave = simd::floor(tableIndex);
+
+                // Gather both mip levels of both waveforms, lane by lane
+                float_4 base[2][2];
+                float_4 next[2][2];
+                for (int lane = 0; lane < 4; ++lane) {
+                        int i = (int)index[lane];
+                        int k = (int)level[lane];
+                        int w = (int)baseWave[lane];
+                        int nextW = std::min(w + 1, set.frames - 1);
+                        const float* lo = set.table(w, k);
+                        const float* hi = set.table(w, k + 1);
+                        const float* nextLo = set.table(nextW, k);
+                        const float* nextHi = set.table(nextW, k + 1);
+                        base[0][0][lane] = lo[i];
+                        base[0][1][lane] = lo[i + 1];
+                        base[1][0][lane] = hi[i];
+                        base[1][1][lane] = hi[i + 1];
+                        next[0][0][lane] = nextLo[i];
+                        next[0][1][lane] = nextLo[i + 1];
+                        next[1][0][lane] = nextHi[i];
+                        next[1][1][lane] = nextHi[i + 1];
+                }
+                auto read = [&](float_4 (&points)[2][2]) {
+                        float_4 a = points[0][0] + (points[0][1] - points[0][0]) * frac;
+                        float_4 b = points[1][0] + (points[1][1] - points[1][0]) * frac;
+                        return a + (b - a) * levelFrac;
+                };
+                float_4 baseSample = read(base);
+                float_4 nextSample = read(next);
 
                 // Shape controls how much we blend to the next waveform
-                float morphAmount = rack::math::clamp(shape, 0.f, 1.f);
-
-                // Sample from base waveform
-                float a0 = modeTables[baseWave][indexA];
-                float a1 = modeTables[baseWave][indexB];
-                float baseSample = rack::math::crossfade(a0, a1, frac);
-
-                // Sample from next waveform
-                float b0 = modeTables[nextWave][indexA];
-                float b1 = modeTables[nextWave][indexB];
-                float nextSample = rack::math::crossfade(b0, b1, frac);
+                float_4 morphAmount = simd::clamp(shape, 0.f, 1.f);
+                float_4 output = baseSample + (nextSample - baseSample) * morphAmount;
 
-                // Morph between them based on shape parameter
-                float output = rack::math::crossfade(baseSample, nextSample, morphAmount);
-
-                return rack::math::clamp(output, -1.1f, 1.1f);
+                return simd::clamp(output, -1.1f, 1.1f);
         }
 };
 
-struct NoiseMod {
-        float heldPhaseJitter = 0.f;
-        float heldAmplitude = 1.f;
-        float heldAdd = 0.f;
+// Per-voice random phase, amplitude and offset, redrawn every sample
+// unless held
+struct NoiseMod4 {
+        NoiseGenerator4 noise;
+        float_4 heldPhaseJitter = 0.f;
+        float_4 heldAmplitude = 1.f;
+        float_4 heldAdd = 0.f;
+
+        // Roughly unit-variance Gaussian noise: sum of three uniforms
+        float_4 gaussian() {
+                return noise.white() + noise.white() + noise.white();
+        }
 
-        void update(float noiseAmt, float sampleRate, bool holdActive) {
-                (void)sampleRate;
+        void update(float_4 noiseAmt, bool holdActive) {
                 if (holdActive)
                         return;
-                float randPhase = random::normal() * noiseAmt * 0.004f;
-                float randAmp = 1.f + random::normal() * noiseAmt * 0.4f;
-                float randAdd = random::normal() * noiseAmt * 0.6f;
-                heldPhaseJitter = randPhase;
-                heldAmplitude = rack::math::clamp(randAmp, 0.2f, 2.2f);
-                heldAdd = rack::math::clamp(randAdd, -1.5f, 1.5f);
+                heldPhaseJitter = gaussian() * noiseAmt * 0.004f;
+                heldAmplitude = simd::clamp(1.f + gaussian() * noiseAmt * 0.4f, 0.2f, 2.2f);
+                heldAdd = simd::clamp(gaussian() * noiseAmt * 0.6f, -1.5f, 1.5f);
         }
 };
 
-struct SimpleComb {
-        std::vector<float> buffer;
+// Comb lines of every voice in one power-of-two ring. Frame i holds one
+// float_4 per voice group, so a group writes its four lines with a single
+// store. The ring is sized off the audio thread; process() only masks.
+struct CombBank {
+        static constexpr int groups = PORT_MAX_CHANNELS / 4;
+
+        std::vector<float_4> buffer;
+        // First-order allpass state, the previous output of each line
+        float_4 allpassState[groups] = {};
+        int mask = 0;
         int index = 0;
-        float sampleRate = 44100.f;
+        float minDelay = 1.f;
+        float maxDelay = 1.f;
 
+        // Delays run from 0.4 ms to 18 ms
         void setSampleRate(float sr) {
-                sampleRate = std::max(1000.f, sr);
-                int desired = static_cast<int>(std::ceil(sampleRate * 0.02f)) + 4;
-                if (desired != static_cast<int>(buffer.size())) {
-                        buffer.assign(desired, 0.f);
+                sr = std::max(1000.f, sr);
+                int size = 1;
+                while (size < static_cast<int>(std::ceil(sr * 0.02f)) + 4)
+                        size <<= 1;
+                if (size - 1 != mask) {
+                        mask = size - 1;
+                        buffer.assign(size * groups, float_4(0.f));
                         index = 0;
+                        for (float_4& state : allpassState)
+                                state = 0.f;
                 }
+                minDelay = sr * 0.0004f;
+                maxDelay = sr * 0.018f;
         }
 
-        float process(float in, float freq, float amount) {
-                if (buffer.empty())
+        // Lines with the comb centred pass their input and keep filling.
+        // delay is the loop length in samples, 1 / dt for a comb tuned to
+        // the oscillator.
+        float_4 process(int group, float_4 in, float_4 delay, float_4 amount) {
+                float_4& slot = buffer[index * groups + group];
+                float_4 polarity = amount - 0.5f;
+                float_4 intensity = simd::fabs(polarity) * 2.f;
+                if (!simd::movemask(intensity > 1e-4f)) {
+                        slot = in;
                         return in;
+                }
+                intensity = simd::ifelse(intensity > 1e-4f, intensity, 0.f);
+
+                float_4 feedback = 0.2f + 0.5f * intensity;
+                float_4 sign = simd::ifelse(polarity < 0.f, -1.f, 1.f);
+
+                // Integer taps N and N + 1 feed an allpass that supplies the
+                // remaining d = delay - N in [0.5, 1.5), where its phase delay
+                // stays flat and its coefficient small. Unlike linear
+                // interpolation it does not damp the highs, so the comb keeps
+                // its peaks at short delays.
+                delay = simd::clamp(delay, minDelay, maxDelay);
+                float_4 taps = simd::floor(delay - 0.5f);
+                float_4 d = delay - taps;
+                float_4 eta = (1.f - d) / (1.f + d);
+
+                float_4 x0, x1;
+                for (int lane = 0; lane < 4; ++lane) {
+                        int n = (int)taps[lane];
+                        x0[lane] = buffer[((index - n) & mask) * groups + group][lane];
+                        x1[lane] = buffer[((index - n - 1) & mask) * groups + group][lane];
+                }
+                float_4& state = allpassState[group];
+                state = eta * (x0 - state) + x1;
+                float_4 delayed = state * sign * intensity;
 
-                float polarity = amount - 0.5f;
-                float intensity = std::fabs(polarity) * 2.f;
-                if (intensity <= 1e-4f)
-                        return in;
+                slot = simd::clamp(in + delayed * feedback, -3.f, 3.f);
+                return in + delayed;
+        }
 
-                float feedback = 0.2f + 0.5f * intensity;
-                float sign = polarity < 0.f ? -1.f : 1.f;
-                float delay = 1.f / std::max(freq, 40.f);
-                delay = rack::math::clamp(delay, 0.0004f, 0.018f);
-                float samples = delay * sampleRate;
-                float read = static_cast<float>(index) - samples;
-                int size = buffer.size();
-                while (read < 0.f)
-                        read += size;
-                int i0 = static_cast<int>(read) % size;
-                int i1 = (i0 + 1) % size;
-                float frac = read - std::floor(read);
-                float delayed = rack::math::crossfade(buffer[i0], buffer[i1], frac);
-
-                float out = rack::math::crossfade(in, in + delayed * sign, intensity);
-                float next = rack::math::crossfade(in, in + delayed * feedback * sign, intensity);
-                next = rack::math::clamp(next, -3.f, 3.f);
-                buffer[index] = next;
-                index = (index + 1) % size;
-                return out;
+        // Called once per sample after every group has been processed
+        void advance() {
+                index = (index + 1) & mask;
         }
 };
 
-struct AsymmetricSoftFold {
-        float process(float in, float amount) {
-                amount = rack::math::clamp(amount, 0.f, 1.f);
-                if (amount <= 1e-4f)
-                        return in;
-
-                float bias = 0.5f + 0.5f * rack::math::clamp(in * (1.f + amount * 3.f), -1.f, 1.f);
-                bias = rack::math::clamp(bias, 0.f, 1.f);
-                float x2 = bias * bias;
-                float x3 = x2 * bias;
-                float x5 = x3 * x2;
+struct AsymmetricSoftFold4 {
+        float_4 process(float_4 in, float_4 amount) {
+                amount = simd::clamp(amount, 0.f, 1.f);
+                float_4 bias = 0.5f + 0.5f * simd::clamp(in * (1.f + amount * 3.f), -1.f, 1.f);
+                float_4 x2 = bias * bias;
+                float_4 x3 = x2 * bias;
+                float_4 x5 = x3 * x2;
                 constexpr float a = 1.6f;
                 constexpr float b = 0.6f;
-                float folded = bias - a * x3 + b * x5;
-                folded = rack::math::clamp((folded - 0.5f) * 2.f, -1.2f, 1.2f);
-                float blend = rack::math::clamp(amount * 0.95f, 0.f, 1.f);
-                return rack::math::crossfade(in, folded, blend);
+                float_4 folded = bias - a * x3 + b * x5;
+                folded = simd::clamp((folded - 0.5f) * 2.f, -1.2f, 1.2f);
+                float_4 blend = simd::clamp(amount * 0.95f, 0.f, 1.f);
+                return simd::ifelse(amount <= 1e-4f, in, in + (folded - in) * blend);
         }
 };
 
@@ -253,19 +544,35 @@ struct Andras : Module {
                 NUM_LIGHTS
         };
 
-        BitTableOsc mainOsc;
-        SimpleComb comb;
-        AsymmetricSoftFold folder;
-        dsp::SchmittTrigger syncTrigger;
-        NoiseMod noiseState;
-        float subPhase = 0.f;
-        float heldPitchCv = 0.f;
-        float heldNoiseCv = 0.f;
-        float heldCombCv = 0.f;
-        float heldShapeCv = 0.f;
-        float heldFoldCv = 0.f;
-        float heldWaveCv = 0.f;
-        float heldTimeCv = 0.f;
+        static constexpr int GROUPS = PORT_MAX_CHANNELS / 4;
+
+        // Voices in float_4 groups; channel c is lane c % 4 of group c / 4
+        BitTableOsc4 mainOsc[GROUPS];
+        NoiseMod4 noiseState[GROUPS];
+        AsymmetricSoftFold4 folder;
+        CombBank comb;
+        dsp::SchmittTrigger syncTriggers[PORT_MAX_CHANNELS];
+        float_4 subPhase[GROUPS] = {};
+        // CVs in 1/5 V, indexed by input id, frozen while HOLD is down
+        float_4 heldCv[SYNC_INPUT][GROUPS] = {};
+
+        // Fetched at construction so the audio thread never builds tables
+        const BitTableStore& store = BitTableStore::get();
+        // User wavetable in use by process(); while it holds a set, that set
+        // replaces the built-in ones of every mode. Replacements are built by
+        // the loader thread.
+        LoadedWavetable* wavetable = nullptr;
+        dspext::SwapSlot<LoadedWavetable> wavetableSlot;
+
+        // Loader thread for user wavetables, started by the first request
+        std::thread loader;
+        std::mutex loaderMutex;
+        std::condition_variable loaderCV;
+        // Guarded by loaderMutex
+        bool loaderQuit = false;
+        bool wavetableRequest = false;
+        std::string wavetablePath;
+        std::string wavetableStatus = "built-in";
 
         Andras() {
                 config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
@@ -293,72 +600,185 @@ struct Andras : Module {
 
                 configOutput(MAIN_OUTPUT, "Out");
                 configOutput(SUB_OUTPUT, "Sub Out");
-        }
 
-        void process(const ProcessArgs& args) override {
-                float sampleRate = args.sampleRate;
-                comb.setSampleRate(sampleRate);
-                bool holdActive = params[HOLD_PARAM].getValue() > 0.5f;
+                for (int g = 0; g < GROUPS; ++g)
+                        noiseState[g].noise.seed(0x414E4400u + g);
 
-                bool sync = syncTrigger.process(inputs[SYNC_INPUT].getVoltage());
-                if (sync)
-                        subPhase = 0.f;
+                comb.setSampleRate(APP->engine->getSampleRate());
+        }
 
-                auto sampleCv = [&](int inputId, float& storage) {
-                        float cv = inputs[inputId].isConnected() ? inputs[inputId].getVoltage() / 5.f : 0.f;
-                        if (!holdActive)
-                                storage = cv;
-                        return storage;
-                };
+        void onSampleRateChange() override {
+                comb.setSampleRate(APP->engine->getSampleRate());
+        }
 
-                float pitchCv = sampleCv(PITCH_INPUT, heldPitchCv);
-                float noiseCv = sampleCv(NOISE_INPUT, heldNoiseCv);
-                float combCv = sampleCv(COMB_INPUT, heldCombCv);
-                float shapeCv = sampleCv(SHAPE_INPUT, heldShapeCv);
-                float foldCv = sampleCv(FOLD_INPUT, heldFoldCv);
-                float waveCv = sampleCv(WAVE_INPUT, heldWaveCv);
-                float timeCv = sampleCv(TIME_INPUT, heldTimeCv);
+        ~Andras() {
+                {
+                        std::lock_guard<std::mutex> lock(loaderMutex);
+                        loaderQuit = true;
+                }
+                wavetableSlot.cancel();
+                loaderCV.notify_one();
+                if (loader.joinable())
+                        loader.join();
+                delete wavetable;
+        }
 
-                float rangeShift = params[RANGE_PARAM].getValue();
-                float rangeOffset = (rangeShift - 1.f) * 2.f; // -2,0,+2 octaves
+        // Queues a user wavetable load; an empty path goes back to the
+        // built-in tables. Safe from any non-audio thread.
+        void requestWavetable(const std::string& path) {
+                {
+                        std::lock_guard<std::mutex> lock(loaderMutex);
+                        wavetablePath = path;
+                        wavetableRequest = true;
+                        wavetableStatus = path.empty() ? "built-in" : "loading...";
+                        if (!loader.joinable())
+                                loader = std::thread(&Andras::loaderLoop, this);
+                }
+                loaderCV.notify_one();
+        }
 
-                float pitch = params[PITCH_PARAM].getValue() + pitchCv + rangeOffset;
-                float freq = dsp::FREQ_C4 * std::pow(2.f, pitch);
-                freq = rack::math::clamp(freq, 5.f, sampleRate * 0.45f);
+        std::string getWavetableStatus() {
+                std::lock_guard<std::mutex> lock(loaderMutex);
+                return wavetableStatus;
+        }
 
-                float noiseAmt = rack::math::clamp(params[NOISE_PARAM].getValue() + noiseCv, 0.f, 1.f);
-                float combAmt = rack::math::clamp(params[COMB_PARAM].getValue() + combCv, 0.f, 1.f);
-                float shape = rack::math::clamp(params[SHAPE_PARAM].getValue() + shapeCv, 0.f, 1.f);
-                float foldAmt = rack::math::clamp(params[SOFTFOLD_PARAM].getValue() + foldCv, 0.f, 1.f);
-                float wave = rack::math::clamp(params[WAVE_PARAM].getValue() + waveCv, 0.f, 1.f);
-                float timeMod = rack::math::clamp(params[TIME_PARAM].getValue() + timeCv, 0.f, 1.f);
+        void loaderLoop() {
+                std::unique_lock<std::mutex> lock(loaderMutex);
+                while (true) {
+                        loaderCV.wait(lock, [&] { return loaderQuit || wavetableRequest; });
+                        if (loaderQuit)
+                                break;
+
+                        std::string path = wavetablePath;
+                        wavetableRequest = false;
+                        lock.unlock();
+
+                        // File reading, decoding and mip analysis all happen here,
+                        // unless another instance already holds the same table
+                        std::shared_ptr<const WaveTableSet> set;
+                        std::string error;
+                        if (!path.empty()) {
+                                set = UserWavetables::get().load(path, error);
+                                if (!set)
+                                        WARN("Andras: failed to load wavetable %s: %s", path.c_str(), error.c_str());
+                        }
+                        if (set || path.empty()) {
+                                LoadedWavetable* loaded = new LoadedWavetable;
+                                loaded->set = set;
+                                wavetableSlot.publish(loaded);
+                        }
 
-                noiseState.update(noiseAmt, sampleRate, holdActive);
-                float jitter = noiseState.heldPhaseJitter * noiseAmt;
-                float amp = rack::math::clamp(noiseState.heldAmplitude, 0.2f, 2.2f);
-                float noiseAdd = noiseState.heldAdd;
+                        lock.lock();
+                        // A newer request reports its own status
+                        if (wavetableRequest || path.empty())
+                                continue;
+                        size_t slash = path.find_last_of("/\\");
+                        std::string name = (slash != std::string::npos) ? path.substr(slash + 1) : path;
+                        if (set)
+                                wavetableStatus = name + " (" + std::to_string(set->frames) + (set->frames == 1 ? " frame)" : " frames)");
+                        else
+                                wavetableStatus = name + ": " + error;
+                }
+        }
 
-                int modeIndex = rack::math::clamp(static_cast<int>(std::round(params[MODE_PARAM].getValue())), 0, 2);
-                float osc = mainOsc.process(freq * (1.f + jitter), wave, shape, timeMod, modeIndex, sampleRate, sync);
-                osc = osc * (1.f - noiseAmt * 0.35f) + random::normal() * noiseAmt * 0.12f;
-                osc *= amp;
-                osc += noiseAdd * 0.1f;
+        json_t* dataToJson() override {
+                json_t* root = json_object();
+                std::string path;
+                {
+                        std::lock_guard<std::mutex> lock(loaderMutex);
+                        path = wavetablePath;
+                }
+                if (!path.empty())
+                        json_object_set_new(root, "wavetablePath", json_string(path.c_str()));
+                return root;
+        }
 
-                float folded = folder.process(osc, foldAmt);
-                float combed = comb.process(folded, freq, combAmt);
+        void dataFromJson(json_t* root) override {
+                json_t* pathJ = json_object_get(root, "wavetablePath");
+                std::string path = (pathJ && json_is_string(pathJ)) ? json_string_value(pathJ) : "";
+                bool loaded;
+                {
+                        std::lock_guard<std::mutex> lock(loaderMutex);
+                        loaded = !wavetablePath.empty();
+                }
+                if (!path.empty() || loaded)
+                        requestWavetable(path);
+        }
 
-                subPhase += (freq * 0.5f) / sampleRate;
-                if (subPhase >= 1.f)
-                        subPhase -= 1.f;
-                float sub = (subPhase * 2.f - 1.f); // Convert to bipolar saw wave
+        void process(const ProcessArgs& args) override {
+                float sampleRate = args.sampleRate;
+                bool holdActive = params[HOLD_PARAM].getValue() > 0.5f;
 
-                float mainOut = rack::math::clamp(combed, -2.5f, 2.5f) * 5.f;
-                float subOut = rack::math::clamp(sub, -1.f, 1.f) * 5.f;
+                // One voice per pitch channel
+                const int channels = std::max(1, inputs[PITCH_INPUT].getChannels());
+                outputs[MAIN_OUTPUT].setChannels(channels);
+                outputs[SUB_OUTPUT].setChannels(channels);
 
-                if (outputs[MAIN_OUTPUT].isConnected())
-                        outputs[MAIN_OUTPUT].setVoltage(mainOut);
-                if (outputs[SUB_OUTPUT].isConnected())
-                        outputs[SUB_OUTPUT].setVoltage(subOut);
+                float rangeShift = params[RANGE_PARAM].getValue();
+                float rangeOffset = (rangeShift - 1.f) * 2.f; // -2,0,+2 octaves
+                int modeIndex = rack::math::clamp(static_cast<int>(std::round(params[MODE_PARAM].getValue())), 0, 2);
+                wavetableSlot.take(wavetable);
+                const WaveTableSet& tables = (wavetable && wavetable->set) ? *wavetable->set : store.mode(modeIndex);
+
+                for (int c = 0; c < channels; c += 4) {
+                        const int g = c / 4;
+
+                        auto sampleCv = [&](int inputId) {
+                                float_4& storage = heldCv[inputId][g];
+                                if (!holdActive)
+                                        storage = inputs[inputId].isConnected() ? inputs[inputId].getPolyVoltageSimd<float_4>(c) / 5.f : 0.f;
+                                return storage;
+                        };
+
+                        float_4 pitchCv = sampleCv(PITCH_INPUT);
+                        float_4 noiseCv = sampleCv(NOISE_INPUT);
+                        float_4 combCv = sampleCv(COMB_INPUT);
+                        float_4 shapeCv = sampleCv(SHAPE_INPUT);
+                        float_4 foldCv = sampleCv(FOLD_INPUT);
+                        float_4 waveCv = sampleCv(WAVE_INPUT);
+                        float_4 timeCv = sampleCv(TIME_INPUT);
+
+                        float_4 syncLanes = 0.f;
+                        for (int lane = 0; lane < 4 && c + lane < channels; ++lane) {
+                                if (syncTriggers[c + lane].process(inputs[SYNC_INPUT].getPolyVoltage(c + lane)))
+                                        syncLanes[lane] = 1.f;
+                        }
+                        float_4 sync = syncLanes > 0.5f;
+                        subPhase[g] = simd::ifelse(sync, 0.f, subPhase[g]);
+
+                        float_4 pitch = params[PITCH_PARAM].getValue() + pitchCv + rangeOffset;
+                        float_4 freq = dsp::FREQ_C4 * simd::exp(pitch * (float)M_LN2);
+                        freq = simd::clamp(freq, 5.f, sampleRate * 0.45f);
+                        // Cycles per sample, shared by the oscillators and the comb
+                        float_4 dt = freq / sampleRate;
+
+                        float_4 noiseAmt = simd::clamp(params[NOISE_PARAM].getValue() + noiseCv, 0.f, 1.f);
+                        float_4 combAmt = simd::clamp(params[COMB_PARAM].getValue() + combCv, 0.f, 1.f);
+                        float_4 shape = simd::clamp(params[SHAPE_PARAM].getValue() + shapeCv, 0.f, 1.f);
+                        float_4 foldAmt = simd::clamp(params[SOFTFOLD_PARAM].getValue() + foldCv, 0.f, 1.f);
+                        float_4 wave = simd::clamp(params[WAVE_PARAM].getValue() + waveCv, 0.f, 1.f);
+                        float_4 timeMod = simd::clamp(params[TIME_PARAM].getValue() + timeCv, 0.f, 1.f);
+
+                        NoiseMod4& noise = noiseState[g];
+                        noise.update(noiseAmt, holdActive);
+                        float_4 jitter = noise.heldPhaseJitter * noiseAmt;
+
+                        float_4 osc = mainOsc[g].process(dt * (1.f + jitter), wave, shape, timeMod, tables, sync);
+                        osc = osc * (1.f - noiseAmt * 0.35f) + noise.gaussian() * noiseAmt * 0.12f;
+                        osc *= noise.heldAmplitude;
+                        osc += noise.heldAdd * 0.1f;
+
+                        float_4 folded = folder.process(osc, foldAmt);
+                        float_4 combed = comb.process(g, folded, 1.f / dt, combAmt);
+
+                        subPhase[g] += dt * 0.5f;
+                        subPhase[g] -= simd::ifelse(subPhase[g] >= 1.f, 1.f, 0.f);
+                        float_4 sub = subPhase[g] * 2.f - 1.f; // Convert to bipolar saw wave
+
+                        outputs[MAIN_OUTPUT].setVoltageSimd(simd::clamp(combed, -2.5f, 2.5f) * 5.f, c);
+                        outputs[SUB_OUTPUT].setVoltageSimd(simd::clamp(sub, -1.f, 1.f) * 5.f, c);
+                }
+                comb.advance();
         }
 };
 
@@ -452,6 +872,27 @@ struct AndrasWidget : ModuleWidget {
                 addOutput(createOutputCentered<DarkPJ301MPort>(mm2px(Vec(52.f, 112.f)), module, Andras::SUB_OUTPUT));
                 addOutput(createOutputCentered<DarkPJ301MPort>(mm2px(Vec(52.f, 120.f)), module, Andras::MAIN_OUTPUT));
         }
+
+        void appendContextMenu(Menu* menu) override {
+                Andras* module = getModule<Andras>();
+                if (!module)
+                        return;
+
+                menu->addChild(new MenuSeparator());
+                menu->addChild(createMenuLabel("Wavetable: " + module->getWavetableStatus()));
+                menu->addChild(createMenuItem("Load wavetable (WAV)", "", [=]() {
+                        osdialog_filters* filters = osdialog_filters_parse("WAV file:wav");
+                        char* path = osdialog_file(OSDIALOG_OPEN, nullptr, nullptr, filters);
+                        osdialog_filters_free(filters);
+                        if (path) {
+                                module->requestWavetable(path);
+                                free(path);
+                        }
+                }));
+                menu->addChild(createMenuItem("Use built-in tables", "", [=]() {
+                        module->requestWavetable("");
+                }));
+        }
 };
 
 Model* modelAndras = createModel<Andras, AndrasWidget>("Andras");
@@ -1,140 +1,259 @@
 #include "plugin.hpp"
 #include "dsp/dsp.hpp"
-#include <array>
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <cstring>
+#include <vector>
 
 using namespace rack;
 
 namespace {
-static constexpr int kNumPartials = 6;
+using simd::float_4;
 
-float saturateFold(float x, float fold) {
-        if (fold <= 0.f)
-                return x;
-        float drive = 1.f + 4.f * fold;
-        float clipped = std::tanh(drive * x);
-        float folded = std::sin((float)M_PI * clipped);
-        return rack::math::crossfade(clipped, folded, fold);
+static constexpr int kNumPartials = 6;
+static constexpr int kMaxVoices = 16;
+static constexpr int kVoiceGroups = kMaxVoices / 4;
+// Below this envelope level a voice is free for a new hit
+static constexpr float kSilentLevel = 1e-5f;
+// Segments in the per-channel envelope and pitch-bend curves
+static constexpr int kCurveSize = 64;
+// Cached hits: slots and frames per slot, and frames between the voice
+// checkpoints playback can resume live synthesis from
+static constexpr int kCacheSlots = 8;
+static constexpr int kCacheFrames = 1 << 15;
+static constexpr int kCheckpointFrames = 64;
+static constexpr int kCheckpoints = kCacheFrames / kCheckpointFrames;
+
+// Linear lookup of x in [0, 1] in a curve of kCurveSize segments
+inline float curveAt(const float* curve, float x) {
+        float pos = rack::math::clamp(x, 0.f, 1.f) * kCurveSize;
+        int index = std::min((int)pos, kCurveSize - 1);
+        return curve[index] + (pos - index) * (curve[index + 1] - curve[index]);
 }
 
-struct PercEnvelope {
-        float env = 0.f;
-        float attackCoef = 0.f;
-        float decayCoef = 0.f;
-        bool inAttack = false;
-
-        void setTimes(float sampleRate, float attackTime, float decayTime) {
-                attackTime = std::max(attackTime, 1e-5f);
-                decayTime = std::max(decayTime, 1e-4f);
-                attackCoef = attackTime <= 1e-4f ? 0.f : std::exp(-1.f / (attackTime * sampleRate));
-                decayCoef = std::exp(-1.f / (decayTime * sampleRate));
+// Same, with a separate curve for every lane
+inline float_4 curveAt(const float* const* curves, float_4 x) {
+        float_4 pos = simd::clamp(x, 0.f, 1.f) * (float)kCurveSize;
+        float_4 index = simd::fmin(simd::floor(pos), (float)(kCurveSize - 1));
+        float_4 lo, hi;
+        for (int lane = 0; lane < 4; ++lane) {
+                int i = (int)index[lane];
+                lo[lane] = curves[lane][i];
+                hi[lane] = curves[lane][i + 1];
         }
+        return lo + (hi - lo) * (pos - index);
+}
 
-        void trigger() {
-                inAttack = true;
-                env = std::max(env, 0.f);
+// Biquad with separate coefficients in every lane
+struct LaneBiquad {
+        float_4 b0 = 1.f, b1 = 0.f, b2 = 0.f;
+        float_4 a1 = 0.f, a2 = 0.f;
+        float_4 z1 = 0.f, z2 = 0.f;
+
+        void setLane(int lane, const BiquadCoeffs& c) {
+                b0[lane] = c.b0;
+                b1[lane] = c.b1;
+                b2[lane] = c.b2;
+                a1[lane] = c.a1;
+                a2[lane] = c.a2;
         }
 
-        float process() {
-                if (inAttack) {
-                        if (attackCoef <= 0.f) {
-                                env = 1.f;
-                                inAttack = false;
-                        } else {
-                                env = 1.f - (1.f - env) * attackCoef;
-                                if (env > 0.999f) {
-                                        env = 1.f;
-                                        inAttack = false;
-                                }
-                        }
-                } else {
-                        env *= decayCoef;
-                        if (env < 1e-6f)
-                                env = 0.f;
-                }
-                return env;
+        float_4 process(float_4 in) {
+                float_4 out = b0 * in + z1;
+                z1 = b1 * in + z2 - a1 * out;
+                z2 = b2 * in - a2 * out;
+                return out;
         }
 };
 
-struct Partial {
-        float phase = 0.f;
-        float baseFreq = 0.f;
-        float amp = 0.f;
-        float env = 0.f;
-        float decay = 0.999f;
-        float fmPhase = 0.f;
-        float jitter = 0.f;
-        float ratio = 1.f;
+// Knob and CV values of one CV channel, and everything derived from them
+// that does not depend on pitch. Shared by every voice playing on it.
+struct HitControls {
+        float spread = 0.f;
+        float morph = 0.f;
+        float fold = 0.f;
+        float harmonic = 0.f;
+        float attackNorm = 0.f;
+        float decayNorm = 0.f;
+        float attackTime = 0.f;
+        int mode = 0;
+        int tone = 0;
+
+        // Spectral targets per partial
+        float ratio[kNumPartials] = {};
+        float amp[kNumPartials] = {};
+        float decay[kNumPartials] = {};
+
+        float attackCoef = 0.f;
+        float decayCoef = 0.f;
+        float noiseCoef = 0.f;
+        float noiseAmount = 0.f;
+        float jitterAmount = 0.f;
+        float oddBoost = 0.f;
+
+        // Kick articulation
+        float attackShape = 1.f;
+        // decayCoef^attackShape, so a decaying shaped envelope is one multiply
+        float shapedDecayCoef = 0.f;
+        float bodyCoef = 0.f;
+        float punchMix = 0.f;
+        float sustainLift = 1.f;
+        float pitchCoef = 0.f;
+        float pitchSemis = 0.f;
+        float transientCoef = 0.f;
+        float transientInc = 0.f;
+        float snapAmount = 0.f;
+        float transientStrength = 0.f;
+        float upperPartialGain = 1.f;
+        float drive = 0.f;
+        float comp = 1.f;
+        float outDrive = 0.f;
+        float outWeight = 1.f;
+
+        // u^(2 * attackShape), looked up at u = sqrt(env) so the steep
+        // start of the curve gets most of the segments
+        float shapeCurve[kCurveSize + 1] = {};
+        float shapeCurveExponent = -1.f;
+        // 2^(pitchSemis * x / 12), looked up at the squared pitch envelope
+        float bendCurve[kCurveSize + 1] = {};
+        float bendCurveSemis = -1.f;
+
+        void updateCurves() {
+                if (attackShape != shapeCurveExponent) {
+                        shapeCurveExponent = attackShape;
+                        for (int k = 0; k <= kCurveSize; ++k)
+                                shapeCurve[k] = std::pow(k / (float)kCurveSize, 2.f * attackShape);
+                }
+                if (pitchSemis != bendCurveSemis) {
+                        bendCurveSemis = pitchSemis;
+                        for (int k = 0; k <= kCurveSize; ++k)
+                                bendCurve[k] = std::pow(2.f, pitchSemis * k / (kCurveSize * 12.f));
+                }
+        }
 };
 
-struct NoiseBurst {
-        float env = 0.f;
-        float decay = 0.99f;
+// State of four voices, one per lane
+struct VoiceGroup {
+        float_4 env;
+        float_4 inAttack;            // 1 while the envelope is rising
+        float_4 level;               // output envelope of the last sample
+        float_4 noiseEnv;
+        float_4 noiseDecay;
+        float_4 baseFreq;
+        float_4 pitchTarget;         // base frequency at the current pitch CV
+        float_4 kickShapedEnv;       // env^attackShape
+        float_4 kickShapeExponent;   // attackShape kickShapedEnv follows
+        float_4 kickPitchEnv;
+        float_4 kickTransientEnv;
+        float_4 kickBodyEnv;
+        float_4 kickTransientPhase;
+        float_4 phase[kNumPartials];
+        float_4 fmPhase[kNumPartials];
+        float_4 partialFreq[kNumPartials];
+        float_4 partialAmp[kNumPartials];
+        float_4 partialEnv[kNumPartials];
+        float_4 jitter[kNumPartials];
+        LaneBiquad lowShelf;
+        LaneBiquad highShelf;
+        NoiseGenerator4 noise;
+
+        void reset(uint32_t seed) {
+                env = inAttack = level = 0.f;
+                noiseEnv = 0.f;
+                noiseDecay = 0.99f;
+                baseFreq = pitchTarget = 110.f;
+                kickShapedEnv = 0.f;
+                kickShapeExponent = -1.f;
+                kickPitchEnv = kickTransientEnv = kickBodyEnv = kickTransientPhase = 0.f;
+                for (int i = 0; i < kNumPartials; ++i) {
+                        phase[i] = fmPhase[i] = 0.f;
+                        partialFreq[i] = 110.f;
+                        partialAmp[i] = partialEnv[i] = jitter[i] = 0.f;
+                }
+                lowShelf = LaneBiquad{};
+                highShelf = LaneBiquad{};
+                noise.seed(seed);
+        }
 
-        void trigger(float decayCoef) {
-                env = 1.f;
-                decay = decayCoef;
+        // Roughly unit-variance Gaussian noise: sum of three uniforms
+        float_4 gaussian() {
+                return noise.white() + noise.white() + noise.white();
         }
 
-        float process() {
-                env *= decay;
-                if (env < 1e-5f)
-                        env = 0.f;
-                return env;
+        // Copies voice srcLane of src into lane
+        void copyLane(int lane, const VoiceGroup& src, int srcLane) {
+                auto copy = [lane, srcLane](float_4& to, const float_4& from) {
+                        to[lane] = from[srcLane];
+                };
+                auto copyBiquad = [&copy](LaneBiquad& to, const LaneBiquad& from) {
+                        copy(to.b0, from.b0);
+                        copy(to.b1, from.b1);
+                        copy(to.b2, from.b2);
+                        copy(to.a1, from.a1);
+                        copy(to.a2, from.a2);
+                        copy(to.z1, from.z1);
+                        copy(to.z2, from.z2);
+                };
+                copy(env, src.env);
+                copy(inAttack, src.inAttack);
+                copy(level, src.level);
+                copy(noiseEnv, src.noiseEnv);
+                copy(noiseDecay, src.noiseDecay);
+                copy(baseFreq, src.baseFreq);
+                copy(pitchTarget, src.pitchTarget);
+                copy(kickShapedEnv, src.kickShapedEnv);
+                copy(kickShapeExponent, src.kickShapeExponent);
+                copy(kickPitchEnv, src.kickPitchEnv);
+                copy(kickTransientEnv, src.kickTransientEnv);
+                copy(kickBodyEnv, src.kickBodyEnv);
+                copy(kickTransientPhase, src.kickTransientPhase);
+                for (int i = 0; i < kNumPartials; ++i) {
+                        copy(phase[i], src.phase[i]);
+                        copy(fmPhase[i], src.fmPhase[i]);
+                        copy(partialFreq[i], src.partialFreq[i]);
+                        copy(partialAmp[i], src.partialAmp[i]);
+                        copy(partialEnv[i], src.partialEnv[i]);
+                        copy(jitter[i], src.jitter[i]);
+                }
+                copyBiquad(lowShelf, src.lowShelf);
+                copyBiquad(highShelf, src.highShelf);
+                noise.state[lane] = src.noise.state[srcLane];
         }
 };
 
-struct ToneShaper {
-        Biquad lowShelf;
-        Biquad highShelf;
-        int lastTone = -1;
-        int lastMode = -1;
-        float lastHarm = -100.f;
-        float lastFold = -100.f;
-
-        float process(float sample, int tone, int mode, float harmonic, float fold, float sampleRate) {
-                bool dirty = false;
-                if (tone != lastTone || mode != lastMode)
-                        dirty = true;
-                if (std::fabs(harmonic - lastHarm) > 0.02f)
-                        dirty = true;
-                if (std::fabs(fold - lastFold) > 0.02f)
-                        dirty = true;
-
-                if (dirty) {
-                        static constexpr struct {
-                                float lowFreq;
-                                float lowGain;
-                                float highFreq;
-                                float highGain;
-                        } toneProfiles[3] = {
-                                {65.f, 9.f, 4200.f, -2.f},
-                                {110.f, 4.f, 7000.f, 2.f},
-                                {180.f, -2.f, 10500.f, 6.f}
-                        };
-                        tone = rack::math::clamp(tone, 0, 2);
-                        auto profile = toneProfiles[tone];
-
-                        float harmonicTilt = (harmonic - 0.5f) * 8.f;
-                        float foldEnergy = fold * 6.f;
-                        float modeLift = (mode == 2) ? 2.5f : (mode == 1 ? 1.2f : 0.4f);
-
-                        float lowGain = profile.lowGain - 0.35f * harmonicTilt - 0.5f * foldEnergy;
-                        float highGain = profile.highGain + harmonicTilt + foldEnergy + modeLift;
-
-                        lowShelf.setLowShelf(sampleRate, profile.lowFreq, lowGain);
-                        highShelf.setHighShelf(sampleRate, profile.highFreq, highGain);
+// Last tone settings each voice's shelves were designed for
+struct ToneState {
+        int tone = -1;
+        int mode = -1;
+        float harmonic = -100.f;
+        float fold = -100.f;
+};
 
-                        lastTone = tone;
-                        lastMode = mode;
-                        lastHarm = harmonic;
-                        lastFold = fold;
-                }
+// One sample of a cached hit
+struct CachedFrame {
+        float out;
+        float env;
+        float level;
+};
 
-                float out = lowShelf.process(sample);
-                out = highShelf.process(out);
-                return out;
-        }
+// A hit rendered once and played back while its key keeps coming up. Hits
+// longer than the buffer keep a snapshot of the voice at the end of it, so
+// playback hands over to live synthesis without a seam. Playback that has
+// to go live earlier renders forward from the last checkpoint with the
+// settings the hit was recorded with.
+struct HitCacheSlot {
+        uint64_t key = 0;            // 0 while empty
+        uint32_t lastUse = 0;
+        int length = 0;              // frames rendered so far
+        int attackFrames = 0;        // frames until the envelope stopped rising
+        bool complete = false;
+        bool hasTail = false;
+        VoiceGroup tail;             // lane 0 holds the voice after the last frame
+        ToneState tailTone;
+        HitControls controls;
+        bool kick = false;
+        float sampleRate = 0.f;
 };
 
 } // namespace
@@ -186,20 +305,60 @@ struct Kabaddon : Module {
                 ARTICULATION_KICK = 1
         };
 
-        PercEnvelope envelope;
-        NoiseBurst noiseBurst;
-        std::array<Partial, kNumPartials> partials;
-        ToneShaper toneShaper;
-        dsp::SchmittTrigger trigTrigger;
+        enum Polyphony {
+                POLY_MONO = 0,
+                POLY_4,
+                POLY_8,
+                POLY_16
+        };
+
+        // Voices in SoA form, four per group. Voice v is lane v % 4 of
+        // group v / 4.
+        VoiceGroup groups[kVoiceGroups];
+        ToneState toneStates[kMaxVoices];
+        int voiceChannel[kMaxVoices] = {};
+        uint32_t voiceAge[kMaxVoices] = {};
+        uint32_t hitCount = 0;
+
+        // One set per CV channel; only the first is used with mono CVs
+        HitControls controls[PORT_MAX_CHANNELS];
+        // Newest voice on each trigger channel, for the envelope output
+        int channelVoice[PORT_MAX_CHANNELS] = {};
+        int lastVoice = 0;
+
+        dsp::SchmittTrigger trigTriggers[PORT_MAX_CHANNELS];
         dsp::SchmittTrigger hitTrigger;
-        float baseFreqState = 110.f;
-        bool initialized = false;
-        float envShape = 0.f;
         int articulationMode = ARTICULATION_PERCUSSIVE;
-        float kickPitchEnv = 0.f;
-        float kickTransientEnv = 0.f;
-        float kickBodyEnv = 0.f;
-        float kickTransientPhase = 0.f;
+        int polyphony = POLY_MONO;
+        int activeVoices = 1;
+
+        // Knob and CV controls are refreshed every CONTROL_BLOCK samples, and
+        // for a trigger channel when it hits
+        static const int CONTROL_BLOCK = 16;
+        int controlCounter = 0;
+        // Control sets computed on the last tick; a change refreshes at once
+        int activeControlChannels = 0;
+
+        // Cached hits. Voice v records or plays back voiceSlot[v] (-1 while
+        // synthesized live), voicePos[v] frames in. The frames and
+        // checkpoints are allocated when the cache is first switched on.
+        std::atomic<bool> cachedHits{false};
+        uint32_t hitSeed = 0;
+        HitCacheSlot cacheSlots[kCacheSlots];
+        std::vector<CachedFrame> cacheFrames;
+        // Checkpoint k of slot s is lane c % 4 of checkpoints[c / 4], with
+        // c = s * kCheckpoints + k
+        std::vector<VoiceGroup> checkpoints;
+        std::vector<ToneState> checkpointTones;
+        int voiceSlot[kMaxVoices] = {};
+        int voicePos[kMaxVoices] = {};
+        bool voiceRecording[kMaxVoices] = {};
+        uint32_t cacheClock = 0;
+        // Starting state of a cached hit's voice
+        VoiceGroup blankGroup;
+        // Lane 0 renders a cached voice forward from a checkpoint
+        VoiceGroup catchUpGroup;
+        ToneState catchUpTones[4];
 
         Kabaddon() {
                 config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
@@ -229,26 +388,83 @@ struct Kabaddon : Module {
                 configOutput(ENV_OUTPUT, "Envelope");
                 configOutput(OUT_OUTPUT, "Audio");
 
+                blankGroup.reset(0);
+                catchUpGroup.reset(0);
+                hitSeed = random::u32();
                 onReset();
         }
 
         void onReset() override {
-                envelope = PercEnvelope{};
-                noiseBurst = NoiseBurst{};
-                for (auto& partial : partials) {
-                        partial = Partial{};
-                        partial.baseFreq = 110.f;
-                        partial.env = 0.f;
-                }
-                baseFreqState = 110.f;
-                initialized = false;
-                kickPitchEnv = 0.f;
-                kickTransientEnv = 0.f;
-                kickBodyEnv = 0.f;
-                kickTransientPhase = 0.f;
-        }
-
-        void updateSpectralTargets(float baseFreq, float spread, float harmonic, int mode, float attackNorm, float decayNorm, float sampleRate, int articulation) {
+                for (int g = 0; g < kVoiceGroups; ++g)
+                        groups[g].reset(0x4B414200u + g);
+                for (int v = 0; v < kMaxVoices; ++v) {
+                        toneStates[v] = ToneState{};
+                        voiceChannel[v] = 0;
+                        voiceAge[v] = 0;
+                        voiceSlot[v] = -1;
+                        voiceRecording[v] = false;
+                }
+                for (int s = 0; s < kCacheSlots; ++s)
+                        cacheSlots[s].key = 0;
+                cacheClock = 0;
+                for (int c = 0; c < PORT_MAX_CHANNELS; ++c)
+                        channelVoice[c] = 0;
+                lastVoice = 0;
+                hitCount = 0;
+                controlCounter = 0;
+                activeControlChannels = 0;
+        }
+
+        int getVoiceCount() const {
+                switch (polyphony) {
+                        default:
+                        case POLY_MONO:
+                                return 1;
+                        case POLY_4:
+                                return 4;
+                        case POLY_8:
+                                return 8;
+                        case POLY_16:
+                                return 16;
+                }
+        }
+
+        float getPitchFreq(int channel) {
+                float pitch = params[PITCH_PARAM].getValue() + inputs[PITCH_INPUT].getPolyVoltage(channel);
+                return rack::math::clamp(dsp::FREQ_C4 * std::pow(2.f, pitch), 10.f, 8000.f);
+        }
+
+        void updateControls(HitControls& c, int channel, float sampleRate, float sampleTime) {
+                auto cv = [this, channel](int input) {
+                        return inputs[input].getPolyVoltage(channel) * 0.1f;
+                };
+                c.spread = rack::math::clamp(params[SPREAD_PARAM].getValue() + cv(SPREAD_INPUT), 0.f, 1.f);
+                c.morph = rack::math::clamp(params[MORPH_PARAM].getValue() + cv(MORPH_INPUT), 0.f, 1.f);
+                c.fold = rack::math::clamp(params[FOLD_PARAM].getValue() + cv(FOLD_INPUT), 0.f, 1.f);
+                c.harmonic = rack::math::clamp(params[HARMONIC_PARAM].getValue() + cv(HARMONIC_INPUT), 0.f, 1.f);
+                c.attackNorm = rack::math::clamp(params[ATTACK_PARAM].getValue() + cv(ATTACK_INPUT), 0.f, 1.f);
+                c.decayNorm = rack::math::clamp(params[DECAY_PARAM].getValue() + cv(DECAY_INPUT), 0.f, 1.f);
+
+                const bool kick = articulationMode == ARTICULATION_KICK;
+                const float attackNorm = c.attackNorm;
+                const float decayNorm = c.decayNorm;
+                const float harmonic = c.harmonic;
+
+                float attackTime = 0.0004f + 0.04f * attackNorm * attackNorm;
+                float decayTime = 0.06f + 2.4f * decayNorm * decayNorm * decayNorm;
+                if (kick) {
+                        attackTime = 0.0002f + 0.01f * attackNorm * attackNorm;
+                        decayTime = 0.04f + 1.4f * decayNorm * decayNorm * decayNorm;
+                }
+                c.attackTime = attackTime;
+
+                float modeControl = params[MODE_PARAM].getValue() + inputs[MODE_INPUT].getPolyVoltage(channel) * 0.2f;
+                c.mode = rack::math::clamp((int)std::round(modeControl), 0, 2);
+                float toneControl = params[TONE_PARAM].getValue() + inputs[TONE_INPUT].getPolyVoltage(channel) * 0.2f;
+                c.tone = rack::math::clamp((int)std::round(toneControl), 0, 2);
+                const int mode = c.mode;
+
+                // Spectral targets
                 static constexpr float harmonicRatios[kNumPartials] = {1.f, 2.f, 3.f, 4.f, 5.f, 7.f};
                 static constexpr float skinRatios[kNumPartials]    = {1.f, 1.5f, 2.f, 2.5f, 3.5f, 5.f};
                 static constexpr float liquidRatios[kNumPartials]  = {1.f, 1.25f, 1.75f, 2.45f, 3.15f, 4.6f};
@@ -262,25 +478,20 @@ struct Kabaddon : Module {
                 }
 
                 float harmonicWeight = 0.55f + 0.75f * harmonic;
-                if (articulation == ARTICULATION_KICK)
+                if (kick)
                         harmonicWeight = 0.32f + 0.45f * harmonic;
 
                 for (int i = 0; i < kNumPartials; ++i) {
-                        float ratio = rack::math::crossfade(harmonicRatios[i], targetRatios[i], spread);
+                        float ratio = rack::math::crossfade(harmonicRatios[i], targetRatios[i], c.spread);
                         ratio = std::max(ratio, 0.1f);
-                        float targetFreq = baseFreq * ratio;
-                        if (!initialized)
-                                partials[i].baseFreq = targetFreq;
-                        else
-                                partials[i].baseFreq += 0.02f * (targetFreq - partials[i].baseFreq);
-                        partials[i].ratio = ratio;
+                        c.ratio[i] = ratio;
 
                         float targetAmp = std::pow(ratio, -harmonicWeight);
                         targetAmp *= 1.f + 0.25f * (mode == 2 ? (i % 2 == 0 ? 1.f : -0.4f) : 0.f);
                         // Boost fundamental and lower partials for more punch
                         if (i == 0) targetAmp *= 1.4f;
                         else if (i == 1) targetAmp *= 1.2f;
-                        if (articulation == ARTICULATION_KICK) {
+                        if (kick) {
                                 float transientScale = 0.45f + 0.4f * attackNorm;
                                 if (i == 0)
                                         targetAmp *= 2.6f + 1.3f * decayNorm;
@@ -291,17 +502,13 @@ struct Kabaddon : Module {
                                         targetAmp *= airy * transientScale;
                                 }
                         }
-                        targetAmp = std::max(targetAmp, 0.0005f);
-                        if (!initialized)
-                                partials[i].amp = targetAmp;
-                        else
-                                partials[i].amp += 0.08f * (targetAmp - partials[i].amp);
+                        c.amp[i] = std::max(targetAmp, 0.0005f);
 
                         float partialBase = 0.05f + 0.03f * i;
                         float partialTime = partialBase * (1.3f - 0.6f * harmonic) * (mode == 0 ? 1.15f : 1.f);
                         if (mode == 2)
                                 partialTime *= 0.75f;
-                        if (articulation == ARTICULATION_KICK) {
+                        if (kick) {
                                 float lowTail = 0.05f + 1.95f * decayNorm * decayNorm;
                                 float midTail = 0.025f + 0.875f * decayNorm;
                                 float highTail = 0.012f + 0.313f * decayNorm;
@@ -316,203 +523,675 @@ struct Kabaddon : Module {
                                 }
                                 partialTime *= rack::math::clamp(1.4f - 0.5f * harmonic, 0.55f, 1.4f);
                         }
-                        float decayCoef = std::exp(-1.f / (std::max(0.006f, partialTime) * sampleRate));
-                        partials[i].decay = decayCoef;
+                        c.decay[i] = std::exp(-1.f / (std::max(0.006f, partialTime) * sampleRate));
+                }
+
+                // Amplitude envelope
+                attackTime = std::max(attackTime, 1e-5f);
+                decayTime = std::max(decayTime, 1e-4f);
+                c.attackCoef = attackTime <= 1e-4f ? 0.f : std::exp(-1.f / (attackTime * sampleRate));
+                c.decayCoef = std::exp(-1.f / (decayTime * sampleRate));
+
+                float noiseDecayTime = 0.006f + 0.02f * (1.f - c.attackTime);
+                if (kick)
+                        noiseDecayTime = 0.0015f + 0.0065f * (1.f - c.attackTime);
+                c.noiseCoef = std::exp(-1.f / (std::max(0.001f, noiseDecayTime) * sampleRate));
+                c.noiseAmount = (0.4f + 0.8f * c.morph) * (mode == 2 ? 2.0f : 1.4f);
+                c.jitterAmount = 0.005f + 0.012f * c.spread;
+                c.oddBoost = 0.4f * (1.f - harmonic);
+
+                if (kick) {
+                        c.noiseAmount = 0.05f + 0.35f * attackNorm + 0.22f * (1.f - harmonic);
+                        c.jitterAmount = 0.002f + 0.004f * c.spread;
+
+                        c.attackShape = 0.45f + 0.35f * attackNorm;
+                        c.shapedDecayCoef = std::pow(c.decayCoef, c.attackShape);
+                        float bodyTime = 0.035f + 1.945f * decayNorm * decayNorm;
+                        c.bodyCoef = std::exp(-sampleTime / std::max(0.015f, bodyTime));
+                        c.punchMix = 0.35f + 0.45f * attackNorm;
+                        c.sustainLift = 0.85f + 0.45f * decayNorm;
+
+                        float pitchSweepTime = 0.002f + 0.015f * (1.f - attackNorm) + 0.06f * decayNorm;
+                        c.pitchCoef = std::exp(-sampleTime / std::max(0.0015f, pitchSweepTime));
+                        c.pitchSemis = rack::math::clamp(6.f + 18.f * attackNorm + 6.f * decayNorm, 6.f, 30.f);
+
+                        float transientTime = 0.0012f + 0.0065f * attackNorm;
+                        c.transientCoef = std::exp(-sampleTime / std::max(0.0006f, transientTime));
+                        c.transientInc = (1800.f + 5200.f * attackNorm) * sampleTime;
+                        c.snapAmount = 0.22f + 0.25f * attackNorm;
+                        c.transientStrength = 0.45f + 0.55f * attackNorm;
+
+                        c.upperPartialGain = rack::math::crossfade(0.25f, 0.65f, attackNorm);
+                        c.drive = 2.4f + 5.2f * c.fold + 1.1f * attackNorm;
+                        c.comp = 0.55f + 0.45f * decayNorm;
+                        c.outDrive = 1.8f + 2.4f * c.fold + 0.6f * attackNorm;
+                        c.outWeight = 0.75f + 0.35f * decayNorm;
+                        c.updateCurves();
                 }
-                initialized = true;
         }
 
-        void triggerVoice(float attackTime, float decayTime, float spread, float harmonic, float sampleRate) {
-                envelope.setTimes(sampleRate, attackTime, decayTime);
-                envelope.trigger();
-                float noiseDecayTime = 0.006f + 0.02f * (1.f - attackTime);
-                if (articulationMode == ARTICULATION_KICK)
-                        noiseDecayTime = 0.0015f + 0.0065f * (1.f - attackTime);
-                float noiseCoef = std::exp(-1.f / (std::max(0.001f, noiseDecayTime) * sampleRate));
-                noiseBurst.trigger(noiseCoef);
+        bool isVoiceActive(int v) const {
+                const VoiceGroup& g = groups[v / 4];
+                return g.inAttack[v % 4] > 0.5f || g.level[v % 4] > kSilentLevel;
+        }
 
-                for (int i = 0; i < kNumPartials; ++i) {
-                        partials[i].env = 1.f;
-                        partials[i].phase = random::uniform();
-                        partials[i].fmPhase = random::uniform();
-                        float jitterAmt = 0.005f + 0.012f * spread;
-                        if (articulationMode == ARTICULATION_KICK)
-                                jitterAmt = 0.002f + 0.004f * spread;
-                        partials[i].jitter = (random::normal() * jitterAmt) * partials[i].baseFreq;
+        // A silent voice if there is one, else the quietest, oldest first.
+        // Voices still in their attack are only taken when nothing else is.
+        int allocateVoice(int voices) {
+                int best = 0;
+                float bestLevel = INFINITY;
+                for (int v = 0; v < voices; ++v) {
+                        const VoiceGroup& g = groups[v / 4];
+                        float level;
+                        if (!isVoiceActive(v))
+                                level = -1.f;
+                        else if (g.inAttack[v % 4] > 0.5f)
+                                level = 2.f;
+                        else
+                                level = g.level[v % 4];
+                        if (level < bestLevel || (level == bestLevel && voiceAge[v] < voiceAge[best])) {
+                                best = v;
+                                bestLevel = level;
+                        }
                 }
+                return best;
+        }
 
-                envShape = 0.f;
-                if (articulationMode == ARTICULATION_KICK) {
-                        kickPitchEnv = 1.f;
-                        kickTransientEnv = 1.f;
-                        kickBodyEnv = 1.f;
-                        kickTransientPhase = 0.f;
+        // Called off the audio thread. Memory stays allocated once the
+        // cache has been used, since playback may still be reading it.
+        void setCachedHits(bool enabled) {
+                if (enabled && cacheFrames.empty()) {
+                        cacheFrames.resize(kCacheSlots * kCacheFrames);
+                        checkpoints.resize(kCacheSlots * kCheckpoints / 4);
+                        checkpointTones.resize(kCacheSlots * kCheckpoints);
                 }
+                cachedHits.store(enabled);
         }
 
-        void process(const ProcessArgs& args) override {
-                float spread = rack::math::clamp(params[SPREAD_PARAM].getValue() + inputs[SPREAD_INPUT].getVoltage() * 0.1f, 0.f, 1.f);
-                float morph = rack::math::clamp(params[MORPH_PARAM].getValue() + inputs[MORPH_INPUT].getVoltage() * 0.1f, 0.f, 1.f);
-                float fold = rack::math::clamp(params[FOLD_PARAM].getValue() + inputs[FOLD_INPUT].getVoltage() * 0.1f, 0.f, 1.f);
-                float harmonic = rack::math::clamp(params[HARMONIC_PARAM].getValue() + inputs[HARMONIC_INPUT].getVoltage() * 0.1f, 0.f, 1.f);
-                float attackNorm = rack::math::clamp(params[ATTACK_PARAM].getValue() + inputs[ATTACK_INPUT].getVoltage() * 0.1f, 0.f, 1.f);
-                float decayNorm = rack::math::clamp(params[DECAY_PARAM].getValue() + inputs[DECAY_INPUT].getVoltage() * 0.1f, 0.f, 1.f);
+        // Hits are cached only while no CV modulates the sound. The pitch CV
+        // is part of the key.
+        bool canCacheHit() {
+                if (!cachedHits.load())
+                        return false;
+                for (int input : {SPREAD_INPUT, MORPH_INPUT, FOLD_INPUT, HARMONIC_INPUT, ATTACK_INPUT, DECAY_INPUT, MODE_INPUT, TONE_INPUT}) {
+                        if (inputs[input].isConnected())
+                                return false;
+                }
+                return true;
+        }
 
-                float attackTime = 0.0004f + 0.04f * attackNorm * attackNorm;
-                float decayTime = 0.06f + 2.4f * decayNorm * decayNorm * decayNorm;
-                if (articulationMode == ARTICULATION_KICK) {
-                        attackTime = 0.0002f + 0.01f * attackNorm * attackNorm;
-                        decayTime = 0.04f + 1.4f * decayNorm * decayNorm * decayNorm;
+        // FNV-1a over everything a cacheable hit depends on
+        uint64_t hitKey(int channel, float sampleRate) {
+                uint64_t key = 0xCBF29CE484222325ull;
+                auto mix = [&key](uint32_t word) {
+                        key = (key ^ word) * 0x100000001B3ull;
+                };
+                auto mixFloat = [&mix](float x) {
+                        uint32_t word;
+                        std::memcpy(&word, &x, sizeof(word));
+                        mix(word);
+                };
+                for (int p = PITCH_PARAM; p <= TONE_PARAM; ++p)
+                        mixFloat(params[p].getValue());
+                mixFloat(inputs[PITCH_INPUT].getPolyVoltage(channel));
+                mixFloat(sampleRate);
+                mix(articulationMode);
+                mix(hitSeed);
+                // 0 marks an empty slot
+                return key ? key : 1;
+        }
+
+        bool isPlayingBack(int v) const {
+                return voiceSlot[v] >= 0 && !voiceRecording[v];
+        }
+
+        // Detaches a voice from its slot, dropping an unfinished recording
+        void releaseSlot(int v) {
+                int slot = voiceSlot[v];
+                if (slot < 0)
+                        return;
+                if (voiceRecording[v] && !cacheSlots[slot].complete)
+                        cacheSlots[slot].key = 0;
+                voiceSlot[v] = -1;
+                voiceRecording[v] = false;
+        }
+
+        // Least recently used slot no voice is reading or writing
+        int findFreeSlot() const {
+                int best = -1;
+                for (int s = 0; s < kCacheSlots; ++s) {
+                        bool busy = false;
+                        for (int v = 0; v < kMaxVoices; ++v)
+                                busy |= voiceSlot[v] == s;
+                        if (busy)
+                                continue;
+                        if (cacheSlots[s].key == 0)
+                                return s;
+                        if (best < 0 || cacheSlots[s].lastUse < cacheSlots[best].lastUse)
+                                best = s;
                 }
+                return best;
+        }
 
-                float pitchParam = params[PITCH_PARAM].getValue();
-                float pitchCv = inputs[PITCH_INPUT].getVoltage();
-                float pitch = pitchParam + pitchCv;
-                float baseFreq = dsp::FREQ_C4 * std::pow(2.f, pitch);
-                baseFreq = rack::math::clamp(baseFreq, 10.f, 8000.f);
+        // Snapshot of a recording voice before the frame it renders next
+        void saveCheckpoint(int v) {
+                const int s = voiceSlot[v];
+                const int c = s * kCheckpoints + cacheSlots[s].length / kCheckpointFrames;
+                checkpoints[c / 4].copyLane(c % 4, groups[v / 4], v % 4);
+                checkpointTones[c] = toneStates[v];
+        }
 
-                if (!initialized)
-                        baseFreqState = baseFreq;
-                baseFreqState += 0.005f * (baseFreq - baseFreqState);
+        // Hands a playing back voice over to live synthesis at its current
+        // frame, rendering forward from the checkpoint before it
+        void resumeLive(int v) {
+                const int s = voiceSlot[v];
+                const HitCacheSlot& slot = cacheSlots[s];
+                const int pos = voicePos[v];
+                const int k = pos / kCheckpointFrames;
+                const int c = s * kCheckpoints + k;
+                catchUpGroup.copyLane(0, checkpoints[c / 4], c % 4);
+                catchUpTones[0] = checkpointTones[c];
+                const HitControls* lc[4] = {&slot.controls, &slot.controls, &slot.controls, &slot.controls};
+                for (int frame = k * kCheckpointFrames; frame < pos; ++frame)
+                        renderGroup(catchUpGroup, catchUpTones, lc, slot.kick, slot.sampleRate, 1.f / slot.sampleRate);
+                groups[v / 4].copyLane(v % 4, catchUpGroup, 0);
+                toneStates[v] = catchUpTones[0];
+                voiceSlot[v] = -1;
+        }
 
-                float modeControl = params[MODE_PARAM].getValue() + inputs[MODE_INPUT].getVoltage() * 0.2f;
-                int mode = rack::math::clamp((int)std::round(modeControl), 0, 2);
+        void startCachedHit(int v, int channel, const HitControls& c, float sampleRate) {
+                const uint64_t key = hitKey(channel, sampleRate);
+                for (int s = 0; s < kCacheSlots; ++s) {
+                        if (cacheSlots[s].key != key)
+                                continue;
+                        // Still being recorded by another voice: stay live
+                        if (!cacheSlots[s].complete)
+                                return;
+                        cacheSlots[s].lastUse = ++cacheClock;
+                        voiceSlot[v] = s;
+                        voicePos[v] = 0;
+                        voiceRecording[v] = false;
+                        return;
+                }
+                int s = findFreeSlot();
+                if (s < 0)
+                        return;
+                HitCacheSlot& slot = cacheSlots[s];
+                slot.key = key;
+                slot.lastUse = ++cacheClock;
+                slot.length = 0;
+                slot.attackFrames = 0;
+                slot.complete = false;
+                slot.hasTail = false;
+                slot.controls = c;
+                slot.kick = articulationMode == ARTICULATION_KICK;
+                slot.sampleRate = sampleRate;
+                voiceSlot[v] = s;
+                voicePos[v] = 0;
+                voiceRecording[v] = true;
+                saveCheckpoint(v);
+        }
 
-                float toneControl = params[TONE_PARAM].getValue() + inputs[TONE_INPUT].getVoltage() * 0.2f;
-                int tone = rack::math::clamp((int)std::round(toneControl), 0, 2);
+        // Ends a recording. A voice that is still sounding is snapshotted so
+        // playback can carry on from the last frame.
+        void finishRecording(int v) {
+                HitCacheSlot& slot = cacheSlots[voiceSlot[v]];
+                if (slot.length == 0) {
+                        releaseSlot(v);
+                        return;
+                }
+                if (isVoiceActive(v)) {
+                        slot.tail.copyLane(0, groups[v / 4], v % 4);
+                        slot.tailTone = toneStates[v];
+                        slot.hasTail = true;
+                }
+                slot.complete = true;
+                voiceSlot[v] = -1;
+                voiceRecording[v] = false;
+        }
 
-                updateSpectralTargets(baseFreqState, spread, harmonic, mode, attackNorm, decayNorm, args.sampleRate, articulationMode);
+        // Stores the frame a recording voice just rendered, until it falls
+        // silent or the buffer is full
+        void recordFrame(int v, float out) {
+                HitCacheSlot& slot = cacheSlots[voiceSlot[v]];
+                const VoiceGroup& g = groups[v / 4];
+                const int lane = v % 4;
+                cacheFrames[voiceSlot[v] * kCacheFrames + slot.length] = {out, g.env[lane], g.level[lane]};
+                slot.length++;
+                if (g.inAttack[lane] > 0.5f)
+                        slot.attackFrames = slot.length;
+                if (!isVoiceActive(v) || slot.length == kCacheFrames)
+                        finishRecording(v);
+                else if (slot.length % kCheckpointFrames == 0)
+                        saveCheckpoint(v);
+        }
 
-                bool trigger = false;
-                if (trigTrigger.process(inputs[TRIG_INPUT].getVoltage()))
-                        trigger = true;
-                if (hitTrigger.process(params[HIT_PARAM].getValue()))
-                        trigger = true;
-                if (trigger)
-                        triggerVoice(attackTime, decayTime, spread, harmonic, args.sampleRate);
-                else
-                        envelope.setTimes(args.sampleRate, attackTime, decayTime);
+        // Next frame of a cached voice. Envelope state follows the recording
+        // so allocation, ENV and the lights treat it like a live voice.
+        float playFrame(int v) {
+                const int s = voiceSlot[v];
+                const HitCacheSlot& slot = cacheSlots[s];
+                VoiceGroup& g = groups[v / 4];
+                const int lane = v % 4;
+                const int pos = voicePos[v]++;
+                const CachedFrame& frame = cacheFrames[s * kCacheFrames + pos];
+                g.env[lane] = frame.env;
+                g.level[lane] = frame.level;
+                g.inAttack[lane] = pos < slot.attackFrames ? 1.f : 0.f;
+                if (voicePos[v] == slot.length) {
+                        if (slot.hasTail) {
+                                g.copyLane(lane, slot.tail, 0);
+                                toneStates[v] = slot.tailTone;
+                        }
+                        voiceSlot[v] = -1;
+                }
+                return frame.out;
+        }
 
-                float env = envelope.process();
-                float envPow = 0.f;
-                if (articulationMode == ARTICULATION_KICK) {
-                        float attackShape = 0.45f + 0.35f * attackNorm;
-                        float shapedEnv = std::pow(rack::math::clamp(env, 0.f, 1.f), attackShape);
-                        float bodyTime = 0.035f + 1.945f * decayNorm * decayNorm;
-                        float bodyCoef = std::exp(-args.sampleTime / std::max(0.015f, bodyTime));
-                        kickBodyEnv *= bodyCoef;
-                        kickBodyEnv = std::max(kickBodyEnv, shapedEnv);
-                        float punchBlend = rack::math::crossfade(kickBodyEnv, shapedEnv, 0.35f + 0.45f * attackNorm);
-                        float sustainLift = 0.85f + 0.45f * decayNorm;
-                        envPow = rack::math::clamp(punchBlend * sustainLift, 0.f, 1.8f);
-                } else {
-                        envShape += 0.05f * (env - envShape);
-                        // Sharper attack envelope for more punch
-                        envPow = env * env * (1.f + 0.3f * env);
+        void triggerVoice(int v, int channel, const HitControls& c, float sampleRate) {
+                VoiceGroup& g = groups[v / 4];
+                const int lane = v % 4;
+
+                // A stolen recording keeps what it has so far, and a voice
+                // still sounding from the cache carries on live
+                if (isPlayingBack(v))
+                        resumeLive(v);
+                if (voiceRecording[v])
+                        finishRecording(v);
+                releaseSlot(v);
+
+                // Cacheable hits start from silence with seeded randomness, so
+                // every hit with the same key renders the same. A voice that is
+                // still sounding is retriggered live, as without the cache.
+                const bool cacheable = canCacheHit() && !isVoiceActive(v);
+                XorShift32 rng;
+                if (cacheable) {
+                        g.copyLane(lane, blankGroup, 0);
+                        toneStates[v] = ToneState{};
+                        rng.seed(hitSeed);
+                        g.noise.state[lane] = (int32_t)rng.next();
+                }
+                auto uniform = [&]() {
+                        return cacheable ? rng.uniform() : random::uniform();
+                };
+                auto normal = [&]() {
+                        return cacheable ? rng.bipolar() + rng.bipolar() + rng.bipolar() : random::normal();
+                };
+
+                // A voice coming out of silence or moving to another channel
+                // starts on its targets instead of gliding from stale ones
+                float base = getPitchFreq(channel);
+                g.pitchTarget[lane] = base;
+                if (!isVoiceActive(v) || voiceChannel[v] != channel) {
+                        g.baseFreq[lane] = base;
+                        for (int i = 0; i < kNumPartials; ++i) {
+                                g.partialFreq[i][lane] = base * c.ratio[i];
+                                g.partialAmp[i][lane] = c.amp[i];
+                        }
+                }
+                voiceChannel[v] = channel;
+                voiceAge[v] = ++hitCount;
+                channelVoice[channel] = v;
+                lastVoice = v;
+
+                g.inAttack[lane] = 1.f;
+                g.env[lane] = std::max(g.env[lane], 0.f);
+                g.noiseEnv[lane] = 1.f;
+                g.noiseDecay[lane] = c.noiseCoef;
+
+                for (int i = 0; i < kNumPartials; ++i) {
+                        g.partialEnv[i][lane] = 1.f;
+                        g.phase[i][lane] = uniform();
+                        g.fmPhase[i][lane] = uniform();
+                        g.jitter[i][lane] = (normal() * c.jitterAmount) * g.partialFreq[i][lane];
                 }
 
-                float pitchBend = 1.f;
                 if (articulationMode == ARTICULATION_KICK) {
-                        float pitchSweepTime = 0.002f + 0.015f * (1.f - attackNorm) + 0.06f * decayNorm;
-                        float pitchCoef = std::exp(-args.sampleTime / std::max(0.0015f, pitchSweepTime));
-                        kickPitchEnv *= pitchCoef;
-                        float shapedPitch = kickPitchEnv * kickPitchEnv;
-                        float pitchSemis = rack::math::clamp(6.f + 18.f * attackNorm + 6.f * decayNorm, 6.f, 30.f);
-                        pitchBend = std::pow(2.f, (shapedPitch * pitchSemis) / 12.f);
+                        g.kickShapeExponent[lane] = c.attackShape;
+                        g.kickPitchEnv[lane] = 1.f;
+                        g.kickTransientEnv[lane] = 1.f;
+                        g.kickBodyEnv[lane] = 1.f;
+                        g.kickTransientPhase[lane] = 0.f;
+                }
+
+                if (cacheable)
+                        startCachedHit(v, channel, c, sampleRate);
+        }
+
+        // Control-rate state of one voice group: pitch targets from the pitch
+        // CV, and kick envelopes whose attack shape moved since the last block
+        void updateGroupControls(int groupIndex, const HitControls* const* lc) {
+                VoiceGroup& g = groups[groupIndex];
+                const bool kick = articulationMode == ARTICULATION_KICK;
+                for (int lane = 0; lane < 4; ++lane) {
+                        g.pitchTarget[lane] = getPitchFreq(voiceChannel[groupIndex * 4 + lane]);
+                        if (!kick) {
+                                g.kickShapeExponent[lane] = -1.f;
+                        } else if (g.kickShapeExponent[lane] != lc[lane]->attackShape) {
+                                float env = rack::math::clamp(g.env[lane], 0.f, 1.f);
+                                g.kickShapedEnv[lane] = curveAt(lc[lane]->shapeCurve, std::sqrt(env));
+                                g.kickShapeExponent[lane] = lc[lane]->attackShape;
+                        }
+                }
+        }
+
+        // Renders one sample of four voices. lc holds each lane's controls
+        // and tones the shelf settings of each lane.
+        float_4 renderGroup(VoiceGroup& g, ToneState* tones, const HitControls* const* lc, bool kick, float sampleRate, float sampleTime) {
+                // With mono CVs every lane shares one control set
+                const bool shared = lc[0] == lc[1] && lc[0] == lc[2] && lc[0] == lc[3];
+                auto gather = [lc, shared](float HitControls::*member) {
+                        if (shared)
+                                return float_4(lc[0]->*member);
+                        return float_4(lc[0]->*member, lc[1]->*member, lc[2]->*member, lc[3]->*member);
+                };
+                float_4 morph = gather(&HitControls::morph);
+                float_4 fold = gather(&HitControls::fold);
+                float_4 mode((float)lc[0]->mode, (float)lc[1]->mode, (float)lc[2]->mode, (float)lc[3]->mode);
+
+                // Pitch and spectral smoothing
+                g.baseFreq += 0.005f * (g.pitchTarget - g.baseFreq);
+
+                float_4 partialDecay[kNumPartials];
+                for (int i = 0; i < kNumPartials; ++i) {
+                        float_4 ratio = lc[0]->ratio[i];
+                        float_4 amp = lc[0]->amp[i];
+                        partialDecay[i] = lc[0]->decay[i];
+                        if (!shared) {
+                                ratio = float_4(lc[0]->ratio[i], lc[1]->ratio[i], lc[2]->ratio[i], lc[3]->ratio[i]);
+                                amp = float_4(lc[0]->amp[i], lc[1]->amp[i], lc[2]->amp[i], lc[3]->amp[i]);
+                                partialDecay[i] = float_4(lc[0]->decay[i], lc[1]->decay[i], lc[2]->decay[i], lc[3]->decay[i]);
+                        }
+                        g.partialFreq[i] += 0.02f * (g.baseFreq * ratio - g.partialFreq[i]);
+                        g.partialAmp[i] += 0.08f * (amp - g.partialAmp[i]);
+                }
+
+                // Amplitude envelope: exponential approach to 1, then decay
+                float_4 attackCoef = gather(&HitControls::attackCoef);
+                float_4 decayCoef = gather(&HitControls::decayCoef);
+                float_4 rising = g.inAttack > 0.5f;
+                float_4 attackStep = simd::ifelse(attackCoef <= 0.f, 1.f, 1.f - (1.f - g.env) * attackCoef);
+                float_4 attackDone = attackStep > 0.999f;
+                float_4 decayed = g.env * decayCoef;
+                decayed = simd::ifelse(decayed < 1e-6f, 0.f, decayed);
+                g.env = simd::ifelse(rising, simd::ifelse(attackDone, 1.f, attackStep), decayed);
+                g.inAttack = simd::ifelse(rising & ~attackDone, 1.f, 0.f);
+                float_4 env = g.env;
+
+                float_4 envPow;
+                float_4 pitchBend;
+                if (kick) {
+                        // A decaying env scales by decayCoef every sample, so its
+                        // shaped power scales by decayCoef^attackShape. Rising
+                        // lanes read the shape curve instead.
+                        float_4 shapedEnv = g.kickShapedEnv * gather(&HitControls::shapedDecayCoef);
+                        if (simd::movemask(rising)) {
+                                const float* curves[4] = {lc[0]->shapeCurve, lc[1]->shapeCurve, lc[2]->shapeCurve, lc[3]->shapeCurve};
+                                float_4 attackEnv = curveAt(curves, simd::sqrt(simd::clamp(env, 0.f, 1.f)));
+                                shapedEnv = simd::ifelse(rising, attackEnv, shapedEnv);
+                        }
+                        shapedEnv = simd::ifelse(env > 0.f, shapedEnv, 0.f);
+                        g.kickShapedEnv = shapedEnv;
+                        g.kickBodyEnv = simd::fmax(g.kickBodyEnv * gather(&HitControls::bodyCoef), shapedEnv);
+                        float_4 punchBlend = g.kickBodyEnv + (shapedEnv - g.kickBodyEnv) * gather(&HitControls::punchMix);
+                        envPow = simd::clamp(punchBlend * gather(&HitControls::sustainLift), 0.f, 1.8f);
+
+                        g.kickPitchEnv *= gather(&HitControls::pitchCoef);
+                        const float* curves[4] = {lc[0]->bendCurve, lc[1]->bendCurve, lc[2]->bendCurve, lc[3]->bendCurve};
+                        pitchBend = curveAt(curves, g.kickPitchEnv * g.kickPitchEnv);
                 } else {
-                        pitchBend = 1.f + spread * 0.7f * envPow;
+                        // Sharper attack envelope for more punch
+                        envPow = env * env * (1.f + 0.3f * env);
+                        pitchBend = 1.f + gather(&HitControls::spread) * 0.7f * envPow;
                 }
-                float body = 0.f;
 
+                // Partial bank
+                float_4 isSkin = mode < 0.5f;
+                float_4 isLiquid = (mode > 0.5f) & (mode < 1.5f);
+                float_4 isMetal = mode > 1.5f;
+                bool anySkin = simd::movemask(isSkin);
+                bool anyLiquid = simd::movemask(isLiquid);
+                bool anyMetal = simd::movemask(isMetal);
+                float_4 oddBoost = gather(&HitControls::oddBoost);
+                float_4 fmRate = simd::ifelse(isLiquid, 0.3f + 0.8f * morph, 0.5f + 1.2f * morph);
+                fmRate = simd::ifelse(isSkin, 0.f, fmRate) * sampleTime;
+                float_4 upperGain = kick ? gather(&HitControls::upperPartialGain) : float_4(1.f);
+
+                // The metal ring pairs partial i with i + 3, reading that
+                // partial's phase before this sample's update
+                float_4 ringPhase[3] = {g.phase[3], g.phase[4], g.phase[5]};
+
+                float_4 body = 0.f;
                 for (int i = 0; i < kNumPartials; ++i) {
-                        auto& p = partials[i];
-                        float freq = p.baseFreq * pitchBend + p.jitter;
-                        freq = std::max(freq, 2.f);
-                        p.phase += freq * args.sampleTime;
-                        p.phase -= std::floor(p.phase);
-
-                        float sine = std::sin(2.f * (float)M_PI * p.phase);
-                        float tri = 2.f * std::fabs(2.f * p.phase - 1.f) - 1.f;
-                        float saw = 2.f * p.phase - 1.f;
-
-                        float wave = 0.f;
-                        if (mode == 0) {
-                                float oddBoost = 0.4f * (1.f - harmonic);
-                                float tilt = rack::math::crossfade(sine, tri, morph * 0.6f);
-                                wave = tilt + oddBoost * (tri - sine * 0.5f);
-                        } else if (mode == 1) {
-                                p.fmPhase += (p.baseFreq * (0.3f + 0.8f * morph)) * args.sampleTime;
-                                p.fmPhase -= std::floor(p.fmPhase);
-                                float fm = std::sin(2.f * (float)M_PI * p.fmPhase);
-                                wave = std::sin(2.f * (float)M_PI * (p.phase + 0.25f * morph * fm));
-                                wave = rack::math::crossfade(wave, saw, 0.25f * morph);
-                        } else {
-                                p.fmPhase += (p.baseFreq * (0.5f + 1.2f * morph)) * args.sampleTime;
-                                p.fmPhase -= std::floor(p.fmPhase);
-                                float fm = std::sin(2.f * (float)M_PI * p.fmPhase);
-                                float ring = sine * std::sin(2.f * (float)M_PI * partials[(i + 3) % kNumPartials].phase);
-                                float metallic = ring + 0.35f * fm + 0.2f * saw;
-                                wave = rack::math::crossfade(sine, metallic, 0.6f + 0.4f * morph);
+                        float_4 freq = simd::fmax(g.partialFreq[i] * pitchBend + g.jitter[i], 2.f);
+                        float_4 phase = g.phase[i] + freq * sampleTime;
+                        phase -= simd::floor(phase);
+                        g.phase[i] = phase;
+
+                        float_4 sine = sin2pi(phase);
+                        float_4 tri = 2.f * simd::fabs(2.f * phase - 1.f) - 1.f;
+                        float_4 saw = 2.f * phase - 1.f;
+
+                        float_4 wave = 0.f;
+                        if (anySkin) {
+                                float_4 tilt = sine + (tri - sine) * (morph * 0.6f);
+                                wave = simd::ifelse(isSkin, tilt + oddBoost * (tri - sine * 0.5f), wave);
+                        }
+                        if (anyLiquid || anyMetal) {
+                                float_4 fmPhase = g.fmPhase[i] + g.partialFreq[i] * fmRate;
+                                fmPhase -= simd::floor(fmPhase);
+                                g.fmPhase[i] = fmPhase;
+                                float_4 fm = sin2pi(fmPhase);
+                                if (anyLiquid) {
+                                        float_4 liquid = sin2pi(phase + 0.25f * morph * fm);
+                                        liquid += (saw - liquid) * (0.25f * morph);
+                                        wave = simd::ifelse(isLiquid, liquid, wave);
+                                }
+                                if (anyMetal) {
+                                        float_4 partner = (i < 3) ? ringPhase[i] : g.phase[i - 3];
+                                        float_4 ring = sine * sin2pi(partner);
+                                        float_4 metallic = ring + 0.35f * fm + 0.2f * saw;
+                                        wave = simd::ifelse(isMetal, sine + (metallic - sine) * (0.6f + 0.4f * morph), wave);
+                                }
                         }
 
-                        if (articulationMode == ARTICULATION_KICK) {
+                        if (kick) {
                                 if (i == 0)
-                                        wave = rack::math::crossfade(wave, sine, 0.75f);
+                                        wave += (sine - wave) * 0.75f;
                                 else if (i == 1)
-                                        wave = rack::math::crossfade(wave, sine, 0.45f);
+                                        wave += (sine - wave) * 0.45f;
                                 else
-                                        wave *= rack::math::crossfade(0.25f, 0.65f, attackNorm);
+                                        wave *= upperGain;
                         }
 
-                        p.env *= p.decay;
-                        body += p.amp * p.env * wave;
+                        g.partialEnv[i] *= partialDecay[i];
+                        body += g.partialAmp[i] * g.partialEnv[i] * wave;
                 }
 
-                float noiseEnv = noiseBurst.process();
-                float noiseAmount = (0.4f + 0.8f * morph) * (mode == 2 ? 2.0f : 1.4f);
-                if (articulationMode == ARTICULATION_KICK)
-                        noiseAmount = 0.05f + 0.35f * attackNorm + 0.22f * (1.f - harmonic);
-                float noise = noiseEnv * (random::normal() * noiseAmount);
+                g.noiseEnv *= g.noiseDecay;
+                g.noiseEnv = simd::ifelse(g.noiseEnv < 1e-5f, 0.f, g.noiseEnv);
+                float_4 noise = g.noiseEnv * g.gaussian() * gather(&HitControls::noiseAmount);
+
+                float_4 transient = 0.f;
+                if (kick) {
+                        g.kickTransientEnv *= gather(&HitControls::transientCoef);
+                        g.kickTransientPhase += gather(&HitControls::transientInc);
+                        g.kickTransientPhase -= simd::floor(g.kickTransientPhase);
+                        float_4 click = sin2pi(g.kickTransientPhase);
+                        float_4 snap = g.gaussian() * gather(&HitControls::snapAmount);
+                        transient = g.kickTransientEnv * gather(&HitControls::transientStrength) * (0.65f * click + 0.35f * snap);
+                }
 
-                float transient = 0.f;
-                if (articulationMode == ARTICULATION_KICK) {
-                        float transientTime = 0.0012f + 0.0065f * attackNorm;
-                        float transientCoef = std::exp(-args.sampleTime / std::max(0.0006f, transientTime));
-                        kickTransientEnv *= transientCoef;
-                        float transientFreq = 1800.f + 5200.f * attackNorm;
-                        kickTransientPhase += transientFreq * args.sampleTime;
-                        kickTransientPhase -= std::floor(kickTransientPhase);
-                        float click = std::sin(2.f * (float)M_PI * kickTransientPhase);
-                        float snap = random::normal() * (0.22f + 0.25f * attackNorm);
-                        float transientStrength = 0.45f + 0.55f * attackNorm;
-                        transient = kickTransientEnv * transientStrength * (0.65f * click + 0.35f * snap);
-                }
-
-                float signal = body + noise + transient;
-                signal = saturateFold(signal, fold);
-                if (articulationMode == ARTICULATION_KICK) {
-                        float drive = 2.4f + 5.2f * fold + 1.1f * attackNorm;
-                        float shapedDrive = std::tanh(signal * drive);
-                        float asym = std::tanh(signal * (drive * 0.65f + 1.7f)) - std::tanh(signal * 0.3f);
-                        float comp = 0.55f + 0.45f * decayNorm;
-                        signal = rack::math::crossfade(signal, shapedDrive + 0.12f * asym, 0.7f);
-                        signal *= comp;
+                float_4 signal = body + noise + transient;
+                // Saturating wavefolder, bypassed at zero fold
+                float_4 folding = fold > 0.f;
+                if (simd::movemask(folding)) {
+                        float_4 clipped = tanhExp((1.f + 4.f * fold) * signal);
+                        float_4 folded = sin2pi(0.5f * clipped);
+                        signal = simd::ifelse(folding, clipped + (folded - clipped) * fold, signal);
+                }
+                if (kick) {
+                        float_4 drive = gather(&HitControls::drive);
+                        float_4 shapedDrive = tanhExp(signal * drive);
+                        float_4 asym = tanhExp(signal * (drive * 0.65f + 1.7f)) - tanhExp(signal * 0.3f);
+                        signal += (shapedDrive + 0.12f * asym - signal) * 0.7f;
+                        signal *= gather(&HitControls::comp);
                 }
                 signal *= envPow;
 
-                float shaped = toneShaper.process(signal, tone, mode, harmonic, fold, args.sampleRate);
-                if (articulationMode == ARTICULATION_KICK) {
-                        float drive = 1.8f + 2.4f * fold + 0.6f * attackNorm;
-                        float weight = 0.75f + 0.35f * decayNorm;
-                        shaped = 5.6f * std::tanh(shaped * drive);
-                        shaped *= weight;
-                } else {
-                        shaped = 6.5f * std::tanh(shaped * 1.1f);
+                // Tone shelves, redesigned per voice when its settings move
+                for (int lane = 0; lane < 4; ++lane) {
+                        const HitControls& c = *lc[lane];
+                        ToneState& ts = tones[lane];
+                        if (c.tone == ts.tone && c.mode == ts.mode && std::fabs(c.harmonic - ts.harmonic) <= 0.02f
+                            && std::fabs(c.fold - ts.fold) <= 0.02f)
+                                continue;
+                        static constexpr struct {
+                                float lowFreq;
+                                float lowGain;
+                                float highFreq;
+                                float highGain;
+                        } toneProfiles[3] = {
+                                {65.f, 9.f, 4200.f, -2.f},
+                                {110.f, 4.f, 7000.f, 2.f},
+                                {180.f, -2.f, 10500.f, 6.f}
+                        };
+                        auto profile = toneProfiles[c.tone];
+
+                        float harmonicTilt = (c.harmonic - 0.5f) * 8.f;
+                        float foldEnergy = c.fold * 6.f;
+                        float modeLift = (c.mode == 2) ? 2.5f : (c.mode == 1 ? 1.2f : 0.4f);
+
+                        float lowGain = profile.lowGain - 0.35f * harmonicTilt - 0.5f * foldEnergy;
+                        float highGain = profile.highGain + harmonicTilt + foldEnergy + modeLift;
+                        g.lowShelf.setLane(lane, lowShelfCoeffs(sampleRate, profile.lowFreq, lowGain));
+                        g.highShelf.setLane(lane, highShelfCoeffs(sampleRate, profile.highFreq, highGain));
+
+                        ts.tone = c.tone;
+                        ts.mode = c.mode;
+                        ts.harmonic = c.harmonic;
+                        ts.fold = c.fold;
                 }
+                float_4 shaped = g.highShelf.process(g.lowShelf.process(signal));
 
-                outputs[OUT_OUTPUT].setVoltage(shaped);
-                outputs[ENV_OUTPUT].setVoltage(env * 10.f);
+                if (kick)
+                        shaped = 5.6f * tanhExp(shaped * gather(&HitControls::outDrive)) * gather(&HitControls::outWeight);
+                else
+                        shaped = 6.5f * tanhExp(shaped * 1.1f);
+
+                g.level = envPow;
+                return shaped;
+        }
+
+        void process(const ProcessArgs& args) override {
+                const int voices = getVoiceCount();
+                if (voices != activeVoices) {
+                        // Voices dropped by a lower polyphony fall silent
+                        for (int v = voices; v < kMaxVoices; ++v) {
+                                VoiceGroup& g = groups[v / 4];
+                                g.env[v % 4] = 0.f;
+                                g.inAttack[v % 4] = 0.f;
+                                g.level[v % 4] = 0.f;
+                                releaseSlot(v);
+                        }
+                        lastVoice = std::min(lastVoice, voices - 1);
+                        for (int c = 0; c < PORT_MAX_CHANNELS; ++c)
+                                channelVoice[c] = std::min(channelVoice[c], voices - 1);
+                        activeVoices = voices;
+                }
+
+                // Each trigger channel is one drum; with mono CVs all of
+                // them share the first control set
+                const int trigChannels = voices > 1 ? std::max(1, inputs[TRIG_INPUT].getChannels()) : 1;
+                int cvChannels = 1;
+                for (int input : {SPREAD_INPUT, MORPH_INPUT, FOLD_INPUT, HARMONIC_INPUT, ATTACK_INPUT, DECAY_INPUT, MODE_INPUT, TONE_INPUT})
+                        cvChannels = std::max(cvChannels, inputs[input].getChannels());
+                const int controlChannels = (voices > 1 && cvChannels > 1) ? std::max(cvChannels, trigChannels) : 1;
+                // Control sets a new channel count brings in are still unset,
+                // and a voice hit with a zero decay would die at once
+                const bool controlTick = controlCounter == 0 || controlChannels != activeControlChannels;
+                controlCounter = (controlCounter + 1) % CONTROL_BLOCK;
+                activeControlChannels = controlChannels;
+                if (controlTick) {
+                        for (int c = 0; c < controlChannels; ++c)
+                                updateControls(controls[c], c, args.sampleRate, args.sampleTime);
+                }
 
+                bool hitPressed = hitTrigger.process(params[HIT_PARAM].getValue());
+                for (int c = 0; c < trigChannels; ++c) {
+                        bool trigger = trigTriggers[c].process(inputs[TRIG_INPUT].getVoltage(c));
+                        if (c == 0 && hitPressed)
+                                trigger = true;
+                        if (!trigger)
+                                continue;
+                        // Hits latch the controls of their exact sample
+                        HitControls& hitControls = controls[controlChannels > 1 ? c : 0];
+                        if (!controlTick)
+                                updateControls(hitControls, controlChannels > 1 ? c : 0, args.sampleRate, args.sampleTime);
+                        triggerVoice(allocateVoice(voices), c, hitControls, args.sampleRate);
+                }
+
+                // Cached voices follow knob and CV moves like live ones: once
+                // the key changes a recording is dropped and playback goes live
+                if (controlTick) {
+                        const bool cacheable = canCacheHit();
+                        for (int v = 0; v < voices; ++v) {
+                                if (voiceSlot[v] < 0)
+                                        continue;
+                                if (cacheable && hitKey(voiceChannel[v], args.sampleRate) == cacheSlots[voiceSlot[v]].key)
+                                        continue;
+                                if (voiceRecording[v])
+                                        releaseSlot(v);
+                                else
+                                        resumeLive(v);
+                        }
+                }
+
+                float out[PORT_MAX_CHANNELS] = {};
+                const int groupCount = (voices + 3) / 4;
+                for (int gi = 0; gi < groupCount; ++gi) {
+                        // Groups with no live voice are skipped
+                        bool live = false;
+                        for (int lane = 0; lane < 4; ++lane) {
+                                int v = gi * 4 + lane;
+                                live |= isVoiceActive(v) && !isPlayingBack(v);
+                        }
+                        if (!live)
+                                continue;
+                        const HitControls* lc[4];
+                        for (int lane = 0; lane < 4; ++lane)
+                                lc[lane] = &controls[controlChannels > 1 ? voiceChannel[gi * 4 + lane] : 0];
+                        if (controlTick)
+                                updateGroupControls(gi, lc);
+                        float_4 voiceOut = renderGroup(groups[gi], &toneStates[gi * 4], lc, articulationMode == ARTICULATION_KICK, args.sampleRate, args.sampleTime);
+                        for (int lane = 0; lane < 4 && gi * 4 + lane < voices; ++lane) {
+                                int v = gi * 4 + lane;
+                                if (isPlayingBack(v))
+                                        continue;
+                                if (voiceRecording[v])
+                                        recordFrame(v, voiceOut[lane]);
+                                out[voiceChannel[v]] += voiceOut[lane];
+                        }
+                }
+                for (int v = 0; v < voices; ++v) {
+                        if (isPlayingBack(v))
+                                out[voiceChannel[v]] += playFrame(v);
+                }
+
+                outputs[OUT_OUTPUT].setChannels(trigChannels);
+                outputs[ENV_OUTPUT].setChannels(trigChannels);
+                for (int c = 0; c < trigChannels; ++c) {
+                        int v = channelVoice[c];
+                        outputs[OUT_OUTPUT].setVoltage(out[c], c);
+                        outputs[ENV_OUTPUT].setVoltage(groups[v / 4].env[v % 4] * 10.f, c);
+                }
+
+                // Lights follow the newest hit
+                const HitControls& lastControls = controls[controlChannels > 1 ? voiceChannel[lastVoice] : 0];
+                float env = groups[lastVoice / 4].env[lastVoice % 4];
+                float envPow = groups[lastVoice / 4].level[lastVoice % 4];
+                int mode = lastControls.mode;
+                int tone = lastControls.tone;
                 lights[MODE1_LIGHT].setSmoothBrightness(mode == 0 ? envPow : 0.f, args.sampleTime);
                 lights[MODE2_LIGHT].setSmoothBrightness(mode == 1 ? envPow : 0.f, args.sampleTime);
                 lights[MODE3_LIGHT].setSmoothBrightness(mode == 2 ? envPow : 0.f, args.sampleTime);
@@ -524,6 +1203,9 @@ struct Kabaddon : Module {
         json_t* dataToJson() override {
                 json_t* root = json_object();
                 json_object_set_new(root, "articulationMode", json_integer(articulationMode));
+                json_object_set_new(root, "polyphony", json_integer(polyphony));
+                json_object_set_new(root, "cachedHits", json_boolean(cachedHits.load()));
+                json_object_set_new(root, "hitSeed", json_integer(hitSeed));
                 return root;
         }
 
@@ -531,6 +1213,15 @@ struct Kabaddon : Module {
                 json_t* modeJ = json_object_get(root, "articulationMode");
                 if (modeJ)
                         articulationMode = json_integer_value(modeJ);
+                json_t* polyJ = json_object_get(root, "polyphony");
+                if (polyJ)
+                        polyphony = rack::math::clamp((int)json_integer_value(polyJ), 0, 3);
+                json_t* cachedJ = json_object_get(root, "cachedHits");
+                if (cachedJ)
+                        setCachedHits(json_boolean_value(cachedJ));
+                json_t* seedJ = json_object_get(root, "hitSeed");
+                if (seedJ)
+                        hitSeed = (uint32_t)json_integer_value(seedJ);
         }
 };
 
@@ -645,6 +1336,13 @@ struct KabaddonWidget : ModuleWidget {
                         {"Percussive", "Kick"},
                         &module->articulationMode
                 ));
+                menu->addChild(createIndexPtrSubmenuItem("Polyphony",
+                        {"Mono", "4 voices", "8 voices", "16 voices"},
+                        &module->polyphony
+                ));
+                menu->addChild(createBoolMenuItem("Cache repeated hits", "",
+                        [=]() { return module->cachedHits.load(); },
+                        [=](bool enabled) { module->setCachedHits(enabled); }));
         }
 };
 
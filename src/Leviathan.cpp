@@ -1,7 +1,6 @@
 #include "plugin.hpp"
+#include "dsp/VitalHost.hpp"
 #include "effects/distortion.h"
-#include "framework/value.h"
-#include "utilities/smooth_value.h"
 #include <array>
 #include <cmath>
 #include <algorithm>
@@ -387,13 +386,10 @@ struct Leviathan : Module {
         std::array<NotchFilter, PORT_MAX_CHANNELS> notchL{};
         std::array<NotchFilter, PORT_MAX_CHANNELS> notchR{};
 
-        // Vital distortion processors
-        std::array<std::unique_ptr<vital::Distortion>, PORT_MAX_CHANNELS> vitalDistL{};
-        std::array<std::unique_ptr<vital::Distortion>, PORT_MAX_CHANNELS> vitalDistR{};
-        std::array<std::unique_ptr<vital::Output>, PORT_MAX_CHANNELS> vitalSigInL{};
-        std::array<std::unique_ptr<vital::Output>, PORT_MAX_CHANNELS> vitalSigInR{};
-        std::array<std::array<vital::Value*, 2>, PORT_MAX_CHANNELS> vitalValsL{};
-        std::array<std::array<vital::Value*, 2>, PORT_MAX_CHANNELS> vitalValsR{};
+        // Vital distortion processors, L/R packed into lanes 0/1 of one instance
+        std::array<dspext::VitalHost<vital::Distortion>, PORT_MAX_CHANNELS> vitalDist;
+        static constexpr int VITAL_TYPE = 0;
+        static constexpr int VITAL_DRIVE = 1;
 
         float bootTimer = 1.2f;
         bool bootActive = true;
@@ -431,26 +427,12 @@ struct Leviathan : Module {
                 configOutput(OUT_L_OUTPUT, "Left audio");
                 configOutput(OUT_R_OUTPUT, "Right audio");
 
-                // Initialize Vital distortion processors for each channel
+                // Initialize Vital distortion processors for each channel.
+                // The fold stage sits mid-chain, so run unbuffered (zero latency).
                 for (int c = 0; c < PORT_MAX_CHANNELS; ++c) {
-                        vitalDistL[c] = std::make_unique<vital::Distortion>();
-                        vitalDistR[c] = std::make_unique<vital::Distortion>();
-
-                        vitalSigInL[c] = std::make_unique<vital::Output>(vital::kMaxBufferSize);
-                        vitalSigInR[c] = std::make_unique<vital::Output>(vital::kMaxBufferSize);
-
-                        vitalDistL[c]->plug(vitalSigInL[c].get(), vital::Distortion::kAudio);
-                        vitalDistR[c]->plug(vitalSigInR[c].get(), vital::Distortion::kAudio);
-
-                        for (size_t i = 0; i < 2; i++) {
-                                vitalValsL[c][i] = new vital::SmoothValue(0);
-                                vitalValsR[c][i] = new vital::SmoothValue(0);
-                        }
-
-                        vitalDistL[c]->plug(vitalValsL[c][0], vital::Distortion::kType);
-                        vitalDistL[c]->plug(vitalValsL[c][1], vital::Distortion::kDrive);
-                        vitalDistR[c]->plug(vitalValsR[c][0], vital::Distortion::kType);
-                        vitalDistR[c]->plug(vitalValsR[c][1], vital::Distortion::kDrive);
+                        vitalDist[c].init(vital::Distortion::kAudio, vital::Distortion::kAudioOut, 1);
+                        vitalDist[c].addParam(vital::Distortion::kType);
+                        vitalDist[c].addParam(vital::Distortion::kDrive);
                 }
 
                 onSampleRateChange();
@@ -469,8 +451,7 @@ struct Leviathan : Module {
                         phaseR[c].set(200.f, sr);
                         notchL[c].set(1000.f, 4.f, sr);
                         notchR[c].set(1000.f, 4.f, sr);
-                        if (vitalDistL[c]) vitalDistL[c]->setSampleRate(sr);
-                        if (vitalDistR[c]) vitalDistR[c]->setSampleRate(sr);
+                        vitalDist[c].setSampleRate(sr);
                 }
         }
 
@@ -486,8 +467,7 @@ struct Leviathan : Module {
                         phaseR[c].reset();
                         notchL[c].reset();
                         notchR[c].reset();
-                        if (vitalDistL[c]) vitalDistL[c]->reset(vital::poly_mask(-1));
-                        if (vitalDistR[c]) vitalDistR[c]->reset(vital::poly_mask(-1));
+                        vitalDist[c].reset();
                 }
         }
 
@@ -544,13 +524,8 @@ struct Leviathan : Module {
                         // Update Vital distortion parameters
                         if (distType > 0) {
                                 float driveDb = -30.f + foldAmount * 60.f;
-                                vitalValsL[c][0]->set(distType - 1); // Type: 0-5 for Vital (subtract 1 because 0 is Infinifolder)
-                                vitalValsL[c][1]->set(driveDb);
-                                vitalValsR[c][0]->set(distType - 1);
-                                vitalValsR[c][1]->set(driveDb);
-
-                                for (auto& val : vitalValsL[c]) { val->process(1); }
-                                for (auto& val : vitalValsR[c]) { val->process(1); }
+                                vitalDist[c].setParam(VITAL_TYPE, distType - 1); // Type: 0-5 for Vital (subtract 1 because 0 is Infinifolder)
+                                vitalDist[c].setParam(VITAL_DRIVE, driveDb);
                         }
 
                         float inL = inputs[IN_L_INPUT].getPolyVoltage(c);
@@ -572,15 +547,9 @@ struct Leviathan : Module {
                                         } else {
                                                 // Use Vital distortion (types 1-6)
                                                 // Normalize to +/- 1.0 range for Vital
-                                                ((vital::mono_float*)vitalSigInL[c]->buffer)[0] = lx / 5.0f;
-                                                ((vital::mono_float*)vitalSigInL[c]->buffer)[1] = 0;
-                                                vitalDistL[c]->process(1);
-                                                lx = ((const vital::mono_float*)vitalDistL[c]->output(vital::Distortion::kAudioOut)->buffer)[0] * 5.0f;
-
-                                                ((vital::mono_float*)vitalSigInR[c]->buffer)[0] = rx / 5.0f;
-                                                ((vital::mono_float*)vitalSigInR[c]->buffer)[1] = 0;
-                                                vitalDistR[c]->process(1);
-                                                rx = ((const vital::mono_float*)vitalDistR[c]->output(vital::Distortion::kAudioOut)->buffer)[0] * 5.0f;
+                                                vitalDist[c].processStereo(lx / 5.0f, rx / 5.0f, lx, rx);
+                                                lx *= 5.0f;
+                                                rx *= 5.0f;
                                         }
                                 };
                                 auto doomStage = [&](float& lx, float& rx) {
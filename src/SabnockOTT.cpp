@@ -1,10 +1,8 @@
 #include "plugin.hpp"
+#include "dsp/VitalHost.hpp"
 #include "effects/compressor.h"
-#include "framework/value.h"
-#include "utilities/smooth_value.h"
 #include <cmath>
 #include <algorithm>
-#include <array>
 
 using namespace rack;
 
@@ -75,13 +73,16 @@ struct SabnockOTT : Module {
 		NUM_LIGHTS
 	};
 
-	// Vital DSP components
-	std::unique_ptr<vital::MultibandCompressor> compressor;
-	std::unique_ptr<vital::Output> sig_in;
-	std::array<vital::Value*, 19> vals = {};
+	// Vital DSP components. The compressor runs on 16-sample blocks
+	// (15 samples of latency); dry/wet mixing happens inside Vital so it stays aligned.
+	static constexpr int VITAL_BLOCK_SIZE = 16;
+	static constexpr int NUM_VITAL_PARAMS = 19;
+	dspext::VitalHost<vital::MultibandCompressor> compressor;
 
 	float in_gain = 1.0f;
 	float out_gain = 1.0f;
+	float inMag = 1.0f;
+	float outMag = 1.0f;
 
 	float crossover1Freq = 120.f;  // Low/Mid split
 	float crossover2Freq = 2500.f; // Mid/High split
@@ -174,29 +175,22 @@ struct SabnockOTT : Module {
 		configInput(INPUT_HIGH_DOWN_RATIO_CV, "High Downward Ratio CV");
 
 		// Initialize vital DSP
-		compressor = std::make_unique<vital::MultibandCompressor>();
-		sig_in = std::make_unique<vital::Output>(vital::kMaxBufferSize);  // Allocate with proper buffer size
-		compressor->plug(sig_in.get(), vital::MultibandCompressor::kAudio);
-
-		// Initialize sample rate BEFORE setting up values
+		compressor.init(vital::MultibandCompressor::kAudio, vital::MultibandCompressor::kAudioOut, VITAL_BLOCK_SIZE);
 		onSampleRateChange();
 
-		initVals();
-		for (int i = 0; i < vals.size(); i++) {
-			compressor->plug(vals[i], i + 1);
+		// Parameter slot i is plugged into compressor input i + 1
+		for (int i = 0; i < NUM_VITAL_PARAMS; i++) {
+			compressor.addParam(i + 1);
 		}
+		setVal(vital::MultibandCompressor::kEnabledBands, vital::MultibandCompressor::kMultiband);
 
 		// Clear all buffers after initialization
-		sig_in->clearBuffer();
-		compressor->reset(vital::constants::kFullMask);
+		compressor.reset();
 		updateParams();
 	}
 
-	void initVals() {
-		for (int i = 0; i < vals.size(); i++) {
-			vals[i] = new vital::SmoothValue(0);
-		}
-		vals[vital::MultibandCompressor::kEnabledBands - 1]->set(vital::MultibandCompressor::kMultiband);
+	void setVal(int compressorInput, float value) {
+		compressor.setParam(compressorInput - 1, value);
 	}
 
 	void updateParams() {
@@ -349,30 +343,30 @@ struct SabnockOTT : Module {
 		hu_ratio = clamp(hu_ratio, 0.0f, 1.0f);
 
 		// Set thresholds
-		vals[vital::MultibandCompressor::kLowLowerThreshold - 1]->set(ll_thres);
-		vals[vital::MultibandCompressor::kLowUpperThreshold - 1]->set(lu_thres);
-		vals[vital::MultibandCompressor::kBandLowerThreshold - 1]->set(bl_thres);
-		vals[vital::MultibandCompressor::kBandUpperThreshold - 1]->set(bu_thres);
-		vals[vital::MultibandCompressor::kHighLowerThreshold - 1]->set(hl_thres);
-		vals[vital::MultibandCompressor::kHighUpperThreshold - 1]->set(hu_thres);
+		setVal(vital::MultibandCompressor::kLowLowerThreshold, ll_thres);
+		setVal(vital::MultibandCompressor::kLowUpperThreshold, lu_thres);
+		setVal(vital::MultibandCompressor::kBandLowerThreshold, bl_thres);
+		setVal(vital::MultibandCompressor::kBandUpperThreshold, bu_thres);
+		setVal(vital::MultibandCompressor::kHighLowerThreshold, hl_thres);
+		setVal(vital::MultibandCompressor::kHighUpperThreshold, hu_thres);
 
 		// Set ratios
 		// Note: Lower = Upward compression (expansion), Upper = Downward compression
-		vals[vital::MultibandCompressor::kLowLowerRatio - 1]->set(ll_ratio);
-		vals[vital::MultibandCompressor::kLowUpperRatio - 1]->set(lu_ratio);
-		vals[vital::MultibandCompressor::kBandLowerRatio - 1]->set(bl_ratio);
-		vals[vital::MultibandCompressor::kBandUpperRatio - 1]->set(bu_ratio);
-		vals[vital::MultibandCompressor::kHighLowerRatio - 1]->set(hl_ratio);
-		vals[vital::MultibandCompressor::kHighUpperRatio - 1]->set(hu_ratio);
+		setVal(vital::MultibandCompressor::kLowLowerRatio, ll_ratio);
+		setVal(vital::MultibandCompressor::kLowUpperRatio, lu_ratio);
+		setVal(vital::MultibandCompressor::kBandLowerRatio, bl_ratio);
+		setVal(vital::MultibandCompressor::kBandUpperRatio, bu_ratio);
+		setVal(vital::MultibandCompressor::kHighLowerRatio, hl_ratio);
+		setVal(vital::MultibandCompressor::kHighUpperRatio, hu_ratio);
 
 		// Set attack/release
-		vals[vital::MultibandCompressor::kAttack - 1]->set(att_time);
-		vals[vital::MultibandCompressor::kRelease - 1]->set(rel_time);
+		setVal(vital::MultibandCompressor::kAttack, att_time);
+		setVal(vital::MultibandCompressor::kRelease, rel_time);
 
 		// Set output gains (from controls)
-		vals[vital::MultibandCompressor::kLowOutputGain - 1]->set(lgain);
-		vals[vital::MultibandCompressor::kBandOutputGain - 1]->set(mgain);
-		vals[vital::MultibandCompressor::kHighOutputGain - 1]->set(hgain);
+		setVal(vital::MultibandCompressor::kLowOutputGain, lgain);
+		setVal(vital::MultibandCompressor::kBandOutputGain, mgain);
+		setVal(vital::MultibandCompressor::kHighOutputGain, hgain);
 
 		// Note: Crossover frequencies are hardcoded in Vital's MultibandCompressor
 		// at 120Hz (low-mid) and 2500Hz (mid-high) and cannot be changed via parameters
@@ -382,69 +376,39 @@ struct SabnockOTT : Module {
 		(void)crossover2Freq;  // Suppress unused variable warning
 
 		// Set mix (dry/wet)
-		vals[vital::MultibandCompressor::kMix - 1]->set(mix);
+		setVal(vital::MultibandCompressor::kMix, mix);
 	}
 
 	void onReset() override {
-		compressor->reset(vital::constants::kFullMask);
+		compressor.reset();
 	}
 
 	void onSampleRateChange() override {
-		if (!compressor) return;
 		float sr = APP ? APP->engine->getSampleRate() : 44100.f;
-		compressor->setSampleRate(sr);
-	}
-
-	void readAudio(vital::poly_float* comp_buf, float* leftBuf, float* rightBuf, int samples) {
-		vital::mono_float* comp_output = (vital::mono_float*)comp_buf;
-		float mag = vital::utils::dbToMagnitude(in_gain);
-
-		for (int i = 0; i < samples; ++i) {
-			comp_output[vital::poly_float::kSize * i + 0] = leftBuf[i] * mag;
-			comp_output[vital::poly_float::kSize * i + 1] = rightBuf[i] * mag;
-		}
-	}
-
-	void writeAudio(vital::poly_float* comp_buf, float* leftBuf, float* rightBuf, int samples) {
-		const vital::mono_float* comp_output = (const vital::mono_float*)comp_buf;
-		float mag = vital::utils::dbToMagnitude(out_gain);
-
-		for (int i = 0; i < samples; ++i) {
-			leftBuf[i] = comp_output[vital::poly_float::kSize * i + 0] * mag;
-			rightBuf[i] = comp_output[vital::poly_float::kSize * i + 1] * mag;
-		}
+		compressor.setSampleRate(sr);
 	}
 
 	void process(const ProcessArgs& args) override {
-		// Update parameters
-		updateParams();
+		// Parameters are only consumed by Vital once per block
+		if (compressor.atBlockStart()) {
+			updateParams();
+			inMag = vital::utils::dbToMagnitude(in_gain);
+			outMag = vital::utils::dbToMagnitude(out_gain);
+		}
 
 		// Get input
 		float inL = inputs[INPUT_L].getVoltage();
 		float inR = inputs[INPUT_R].isConnected() ? inputs[INPUT_R].getVoltage() : inL;
 
 		// Convert from 5V to normalized float (assuming +/- 5V range)
-		float leftBuf = inL / 5.0f;
-		float rightBuf = inR / 5.0f;
-
-		// Process values (smooth parameters)
-		for (auto& val : vals) {
-			val->process(1);
-		}
-
-		// Read audio into vital buffer
-		readAudio(sig_in->buffer, &leftBuf, &rightBuf, 1);
-
-		// Process compression
-		compressor->process(1);
+		float leftBuf = inL / 5.0f * inMag;
+		float rightBuf = inR / 5.0f * inMag;
 
-		// Write audio from vital buffer
-		writeAudio(compressor->output(vital::MultibandCompressor::kAudioOut)->buffer,
-		           &leftBuf, &rightBuf, 1);
+		compressor.processStereo(leftBuf, rightBuf, leftBuf, rightBuf);
 
 		// Convert back to 5V range and output
-		outputs[OUTPUT_L].setVoltage(leftBuf * 5.0f);
-		outputs[OUTPUT_R].setVoltage(rightBuf * 5.0f);
+		outputs[OUTPUT_L].setVoltage(leftBuf * outMag * 5.0f);
+		outputs[OUTPUT_R].setVoltage(rightBuf * outMag * 5.0f);
 	}
 };
 
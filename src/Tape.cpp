@@ -2,11 +2,17 @@
 #include "dsp/dsp.hpp"
 #include "dsp/p42.hpp"
 #include "dsp/Saturation.hpp"
+#include "dsp/Hysteresis.hpp"
 #include <cmath>
+#include <algorithm>
+#include <array>
+#include <cstring>
 #define MAX_DELAY_SAMPLES 512
 #define TAPE_DELAY_BUFFER_SIZE 2048
 #define BASE_DELAY_SAMPLES 64
 
+using simd::float_4;
+
 static const float modeBias[3] = {1.4f, 1.2f, 1.0f};
 static const float modeDrive[3] = {1.2f, 1.0f, 0.8f};
 static const float modeTone[3] = {0.8f, 0.9f, 1.0f};
@@ -32,6 +38,9 @@ static const float speedCutoffScale[3] = {0.6f, 0.8f, 1.0f};
 static const float speedModScale[3]    = {2.0f, 1.0f, 0.5f};
 static const float speedNoiseScale[3]  = {1.5f, 1.0f, 0.8f};
 
+// Stereo wow/flutter decorrelation. Index 0 = Linked, 1 = Subtle, 2 = Wide
+static const float stereoSpreadAmount[3] = {0.f, 0.3f, 1.f};
+
 struct EqCurve {
     float lowFreq;
     float lowGainDb;
@@ -45,31 +54,42 @@ static const EqCurve eqCurves[] = {
     {80.f, 3.f, 12000.f, 3.f}   // Mix
 };
 
+// Tape processes up to PORT_MAX_CHANNELS voices, each with a left and right
+// lane. Lanes are grouped into simd::float_4 vectors: group g < GROUPS_PER_SIDE
+// holds left channels 4g..4g+3, group GROUPS_PER_SIDE + g the matching rights.
+static const int GROUPS_PER_SIDE = PORT_MAX_CHANNELS / 4;
+static const int MAX_GROUPS = 2 * GROUPS_PER_SIDE;
+
 struct TapeAging {
 	float eqWarmState = 0.f;
 	float eqDrift = 1.f;
 
-        float printBuffer[MAX_DELAY_SAMPLES * 2] = {};
+        float_4 printBuffer[MAX_DELAY_SAMPLES * 2] = {};
         int printIndex = 0;
-        float printEchoSmooth = 0.f;
-        float printEchoAir = 0.f;
+        float_4 printEchoSmooth = 0.f;
+        float_4 printEchoAir = 0.f;
+
+        // Echo smoothing coefficient, recomputed only when drift or rate move
+        float echoAlpha = 0.f;
+        float echoAlphaDrift = -1.f;
+        float echoAlphaRate = 0.f;
 
         void tickDrift() {
                 eqWarmState += 0.00001f;
                 eqDrift = 1.f + 0.05f * std::sin(eqWarmState);
         }
 
-        void storePrint(float sample) {
+        void storePrint(float_4 sample) {
                 printBuffer[printIndex] = sample;
                 printIndex = (printIndex + 1) % (MAX_DELAY_SAMPLES * 2);
         }
 
-        float getPrintEcho(float sampleRate) {
+        float_4 getPrintEcho(float sampleRate) {
                 const int bufferSize = MAX_DELAY_SAMPLES * 2;
                 if (sampleRate <= 0.f)
                         return 0.f;
 
-                auto hermite = [](float a, float b, float c, float d, float t) {
+                auto hermite = [](float_4 a, float_4 b, float_4 c, float_4 d, float t) {
                         float t2 = t * t;
                         float t3 = t2 * t;
                         return 0.5f * ((2.f * b) + (-a + c) * t + (2.f * a - 5.f * b + 4.f * c - d) * t2 + (-a + 3.f * b - 3.f * c + d) * t3);
@@ -91,31 +111,35 @@ struct TapeAging {
                         return printBuffer[idx];
                 };
 
-                float mainEcho = hermite(sampleAt(-1), sampleAt(0), sampleAt(1), sampleAt(2), frac);
-                float smearEcho = 0.5f * (sampleAt(-48) + sampleAt(-47));
+                float_4 mainEcho = hermite(sampleAt(-1), sampleAt(0), sampleAt(1), sampleAt(2), frac);
+                float_4 smearEcho = 0.5f * (sampleAt(-48) + sampleAt(-47));
 
                 float amplitude = 0.008f * (0.7f + 0.3f * eqDrift);
-                float combined = amplitude * (0.75f * mainEcho + 0.25f * smearEcho);
-
-                float cutoff = 1800.f * (0.9f + 0.1f * eqDrift);
-                cutoff = rack::math::clamp(cutoff, 200.f, 6000.f);
-                float alpha = std::exp(-2.f * M_PI * cutoff / sampleRate);
-                alpha = rack::math::clamp(alpha, 0.0001f, 0.9999f);
+                float_4 combined = amplitude * (0.75f * mainEcho + 0.25f * smearEcho);
+
+                if (eqDrift != echoAlphaDrift || sampleRate != echoAlphaRate) {
+                        float cutoff = 1800.f * (0.9f + 0.1f * eqDrift);
+                        cutoff = rack::math::clamp(cutoff, 200.f, 6000.f);
+                        echoAlpha = rack::math::clamp(onePoleCoeff(cutoff, sampleRate), 0.0001f, 0.9999f);
+                        echoAlphaDrift = eqDrift;
+                        echoAlphaRate = sampleRate;
+                }
+                float alpha = echoAlpha;
                 printEchoSmooth = alpha * printEchoSmooth + (1.f - alpha) * combined;
                 printEchoAir += 0.05f * (printEchoSmooth - printEchoAir);
                 return printEchoAir;
         }
 };
 
+// One delay line per lane group. All lanes share the same modulated read
+// position, so every read is a single aligned float_4 load.
 class TapeDelayBuffer {
 public:
-        float buffer[PORT_MAX_CHANNELS][TAPE_DELAY_BUFFER_SIZE] = {};
+        float_4 buffer[TAPE_DELAY_BUFFER_SIZE] = {};
         int writeIndex = 0;
-        float modSmooth[PORT_MAX_CHANNELS] = {};
-        float prevOut[PORT_MAX_CHANNELS] = {};
-        float prevDelay[PORT_MAX_CHANNELS] = {};
+        float modSmooth = 0.f;
 
-	float hermiteInterpolate(float a, float b, float c, float d, float t) {
+	float_4 hermiteInterpolate(float_4 a, float_4 b, float_4 c, float_4 d, float t) {
 		float t2 = t * t;
 		float t3 = t2 * t;
 		return 0.5f * (
@@ -126,20 +150,36 @@ public:
 		);
 	}
 
-	float readModulated(float input, float delaySamples, int channel, float sampleRate) {
+	// Moves the smoothed read position towards the modulated delay. Also
+	// called on its own while the module sleeps, when the buffer holds a
+	// settled constant and nothing needs to be written.
+	void track(float delaySamples, float sampleRate) {
 		float totalDelay = BASE_DELAY_SAMPLES + delaySamples;
 		// Ensure enough buffer history for Hermite (needs at least 3 past samples)
 		totalDelay = rack::math::clamp(totalDelay, 4.f, (float)(TAPE_DELAY_BUFFER_SIZE - 4));
 
 		// Smoothing to prevent rapid pointer jumps (already good)
 		float smoothing = 0.002f * 44100.f / sampleRate;
-		modSmooth[channel] += smoothing * (totalDelay - modSmooth[channel]);
+		modSmooth += smoothing * (totalDelay - modSmooth);
+	}
+
+	float_4 readModulated(float_4 input, float delaySamples, float sampleRate) {
+		track(delaySamples, sampleRate);
 
 		// === WRITE INPUT ===
-		buffer[channel][writeIndex] = input;
+		buffer[writeIndex] = input;
+
+		// Without transport modulation the read sits on the base delay, so
+		// skip the interpolation
+		if (delaySamples == 0.f && std::fabs(modSmooth - BASE_DELAY_SAMPLES) < 1e-4f) {
+			modSmooth = BASE_DELAY_SAMPLES;
+			float_4 out = buffer[(writeIndex - BASE_DELAY_SAMPLES + TAPE_DELAY_BUFFER_SIZE) % TAPE_DELAY_BUFFER_SIZE];
+			writeIndex = (writeIndex + 1) % TAPE_DELAY_BUFFER_SIZE;
+			return out;
+		}
 
 		// === FLOAT READ INDEX ===
-		float floatIndex = (float)writeIndex - modSmooth[channel];
+		float floatIndex = (float)writeIndex - modSmooth;
 		while (floatIndex < 0.f)
 			floatIndex += (float)TAPE_DELAY_BUFFER_SIZE;
 		floatIndex = fmodf(floatIndex, (float)TAPE_DELAY_BUFFER_SIZE);
@@ -152,12 +192,7 @@ public:
 		int index1  = (index0 + 1) % TAPE_DELAY_BUFFER_SIZE;
 		int index2  = (index0 + 2) % TAPE_DELAY_BUFFER_SIZE;
 
-		float a = buffer[channel][indexM1];
-		float b = buffer[channel][index0];
-		float c = buffer[channel][index1];
-		float d = buffer[channel][index2];
-
-		float out = hermiteInterpolate(a, b, c, d, frac);
+		float_4 out = hermiteInterpolate(buffer[indexM1], buffer[index0], buffer[index1], buffer[index2], frac);
 
 		// === ADVANCE WRITE POINTER ===
 		writeIndex = (writeIndex + 1) % TAPE_DELAY_BUFFER_SIZE;
@@ -165,8 +200,14 @@ public:
 	}
 };
 
+// Tape transport shared by every channel and advanced once per frame. The
+// random walks use a seeded generator so a saved patch renders the same way
+// every time. The right side reads the same transport at a phase offset set
+// by the stereo spread, so 0 keeps both sides locked together.
 class WowFlutterModulator {
 public:
+    XorShift32 rng;
+
     // WOW state
     float wowPhase = 0.f;
     float wowFreqMod = 0.f;
@@ -174,7 +215,7 @@ public:
     float wowFreqTarget = 0.f;
     float wowAmpTarget = 1.f;
     int wowTimer = 0;
-    float wowLFOFiltered = 0.f;
+    float wowLFOFiltered[2] = {};
 
     // FLUTTER state (restored expressive style)
     float flutterPhase = 0.f;
@@ -183,17 +224,26 @@ public:
     float flutterAmp = 1.f;
     float flutterAmpTarget = 1.f;
     int flutterTimer = 0;
-    float flutterLFO = 0.f;
+    float flutterLFO[2] = {};
 
     // Output smoothing
-    float smoothed = 0.f;
-    float smoothed2 = 0.f;
+    float smoothed[2] = {};
+    float smoothed2[2] = {};
+
+    void seed(uint32_t s) {
+        rng.seed(s);
+        wowPhase = flutterPhase = 0.f;
+        wowTimer = flutterTimer = 0;
+    }
+
+    // Writes the left and right modulation for this frame
+    void compute(float sampleRate, float wowAmount, float flutterAmount, float spread, float out[2]) {
+        const SineTable& sine = SineTable::get();
 
-    float compute(float sampleRate, float wowAmount, float flutterAmount) {
         // === WOW (slow LFO) ===
         if (--wowTimer <= 0) {
-            wowFreqTarget = (2.f * random::uniform() - 1.f) * 0.03f;  // ±0.03 Hz
-            wowAmpTarget = 1.f + 0.1f * (2.f * random::uniform() - 1.f); // ±10%
+            wowFreqTarget = rng.bipolar() * 0.03f;  // ±0.03 Hz
+            wowAmpTarget = 1.f + 0.1f * rng.bipolar(); // ±10%
             wowTimer = static_cast<int>(0.1f * sampleRate);
         }
 
@@ -201,15 +251,12 @@ public:
         float wowSpeed = 0.35f + wowFreqMod;
         wowPhase += wowSpeed / sampleRate;
         if (wowPhase > 1.f) wowPhase -= 1.f;
-
         wowAmp += 0.001f * (wowAmpTarget - wowAmp);
-        float wowLFO = wowAmp * std::sin(2.f * M_PI * wowPhase);
-        wowLFOFiltered += 0.01f * (wowLFO - wowLFOFiltered);
 
         // === FLUTTER (faster, expressive LFO) ===
         if (--flutterTimer <= 0) {
-            flutterFreqTarget = (2.f * random::uniform() - 1.f) * 0.5f;  // ±0.5 Hz
-            flutterAmpTarget = 1.f + 0.2f * (2.f * random::uniform() - 1.f); // ±20%
+            flutterFreqTarget = rng.bipolar() * 0.5f;  // ±0.5 Hz
+            flutterAmpTarget = 1.f + 0.2f * rng.bipolar(); // ±20%
             flutterTimer = static_cast<int>(0.02f * sampleRate);  // 50 updates/sec
         }
 
@@ -220,20 +267,55 @@ public:
         flutterPhase += flutterSpeed / sampleRate;
         if (flutterPhase > 1.f) flutterPhase -= 1.f;
 
-        float rawFlutter = flutterAmp * std::sin(2.f * M_PI * flutterPhase);
-        flutterLFO += 0.02f * (rawFlutter - flutterLFO);  // Soft smoothing
-
-        // === Combine and clamp ===
-        float mod = wowAmount * wowLFOFiltered + flutterAmount * flutterLFO;
-        // Allow deeper modulation range for more audible wow and flutter
-        mod = rack::math::clamp(mod, -0.30f, 0.30f);
-
-        // Two-stage smoothing for delay modulation safety
         float smoothingFactor = rack::math::clamp(0.001f * 44100.f / sampleRate, 0.001f, 0.01f);
-        smoothed += smoothingFactor * (mod - smoothed);
-        smoothed2 += smoothingFactor * (smoothed - smoothed2);
+        int sides = (spread > 0.f) ? 2 : 1;
+        for (int s = 0; s < sides; s++) {
+            // Quarter-cycle wow offset and a wider flutter offset at full spread
+            float wowOffset = s * 0.25f * spread;
+            float flutterOffset = s * 0.37f * spread;
+
+            float wowLFO = wowAmp * sine(wowPhase + wowOffset);
+            wowLFOFiltered[s] += 0.01f * (wowLFO - wowLFOFiltered[s]);
+
+            float rawFlutter = flutterAmp * sine(flutterPhase + flutterOffset);
+            flutterLFO[s] += 0.02f * (rawFlutter - flutterLFO[s]);  // Soft smoothing
+
+            // === Combine and clamp ===
+            float mod = wowAmount * wowLFOFiltered[s] + flutterAmount * flutterLFO[s];
+            // Allow deeper modulation range for more audible wow and flutter
+            mod = rack::math::clamp(mod, -0.30f, 0.30f);
+
+            // Two-stage smoothing for delay modulation safety
+            smoothed[s] += smoothingFactor * (mod - smoothed[s]);
+            smoothed2[s] += smoothingFactor * (smoothed[s] - smoothed2[s]);
+            out[s] = smoothed2[s];
+        }
+        if (sides == 1) {
+            // Keep the right side's filters tracking so raising spread is smooth
+            wowLFOFiltered[1] = wowLFOFiltered[0];
+            flutterLFO[1] = flutterLFO[0];
+            smoothed[1] = smoothed[0];
+            smoothed2[1] = smoothed2[0];
+            out[1] = out[0];
+        }
+    }
 
-        return smoothed2;
+    // True when the output has decayed to silence. Callers with zero wow and
+    // flutter can then call advancePhases() instead of compute().
+    bool isSettled() const {
+        for (int s = 0; s < 2; s++) {
+            if (std::fabs(smoothed[s]) > 1e-7f || std::fabs(smoothed2[s]) > 1e-7f)
+                return false;
+        }
+        return true;
+    }
+
+    // Keeps the LFO phases running for the modulations that follow them
+    void advancePhases(float sampleRate) {
+        wowPhase += (0.35f + wowFreqMod) / sampleRate;
+        if (wowPhase > 1.f) wowPhase -= 1.f;
+        flutterPhase += (6.0f + flutterFreqMod) / sampleRate;
+        if (flutterPhase > 1.f) flutterPhase -= 1.f;
     }
 
     float getWowPhase() const { return wowPhase; }
@@ -241,25 +323,74 @@ public:
 };
 
 
+// Hiss and static for one lane group, generated a block at a time from
+// seeded SIMD noise. The shaping filters are linear, so the buffers hold
+// unit-level noise and the gains are applied per sample when reading.
+struct TapeNoise {
+        static const int BLOCK = 16;
+
+        NoiseGenerator4 hissRng;
+        NoiseGenerator4 staticRng;
+
+        float_4 hissHP = 0.f;
+        float_4 hissBP = 0.f;
+        float_4 hissLP = 0.f;
+        float_4 staticHP = 0.f;
+        float_4 staticBP = 0.f;
+        float_4 staticLP = 0.f;
+
+        float_4 hiss[BLOCK] = {};
+        float_4 tapeStatic[BLOCK] = {};
+
+        void seed(uint32_t s) {
+                hissRng.seed(s);
+                staticRng.seed(s ^ 0x5bd1e995u);
+        }
+
+        void fillHiss() {
+                for (int i = 0; i < BLOCK; i++) {
+                        float_4 white = hissRng.white();
+                        float_4 hp = white - hissHP;
+                        hissHP = white;
+                        float_4 bp = hp - hissBP * 0.9f;
+                        hissBP = bp;
+                        hissLP += 0.05f * (1.5f * bp - hissLP);
+                        hiss[i] = hissLP;
+                }
+        }
+
+        void fillStatic() {
+                for (int i = 0; i < BLOCK; i++) {
+                        float_4 white = staticRng.white();
+                        float_4 hp = white - staticHP;
+                        staticHP = white;
+                        float_4 bp = hp - staticBP * 0.85f;
+                        staticBP = bp;
+                        staticLP += 0.03f * (bp - staticLP);
+                        tapeStatic[i] = 0.9f * staticLP;
+                }
+        }
+};
+
 class TapeGlue {
 public:
-        float env = 0.f;
-        float hpState = 0.f;        // sidechain high-pass state
+        float_4 env = 0.f;
+        float_4 hpState = 0.f;        // sidechain high-pass state
 
         // x: signal to compress
         // sc: sidechain signal used for level detection
-        float process(float x, float amount, int algo, float sc) {
+        float_4 process(float_4 x, float amount, int algo, float_4 sc) {
                         // High-pass sidechain so bass passes more freely
-                        float hp = sc - hpState;
+                        float_4 hp = sc - hpState;
                         hpState += 0.01f * hp;
 
-                        float rect = std::fabs(hp);
+                        float_4 rect = simd::fabs(hp);
                         env += 0.01f * (rect - env);
                         float threshold = 0.4f; 
                         // Lower threshold so compression engages at more typical levels
-                        float compEnv = std::max(0.f, env - threshold);
+                        float_4 compEnv = simd::fmax(0.f, env - threshold);
 
-			float gain = 1.f;
+			float_4 gain = 1.f;
 			switch (algo) {
 					default:
 					case 0:
@@ -276,9 +407,9 @@ public:
 							break;
 			}
 
-			float compressed = x * gain;
+			float_4 compressed = x * gain;
 			// Mild saturation for extra warmth when glue is engaged
-			float warmed = std::tanh(compressed * (1.f + 0.5f * amount));
+			float_4 warmed = tanhExp(compressed * (1.f + 0.5f * amount));
 			return 0.6f * warmed + 0.4f * compressed;
         }
 };
@@ -324,48 +455,89 @@ struct Tape : Module {
 		LIGHTS_LEN
 	};
 
-       // 2× oversampling is a good CPU compromise
-       static const int OS_FACTOR = 2;
-
-       struct ChannelState {
-               float biasState = 0.f;
-               float toneState = 0.f;
-               float deEmphasisState = 0.f;
-               float lowpassState = 0.f;
-               float brightnessState = 0.f;
-               float prevSaturated = 0.f;
+       // Saturator oversampling tiers selectable from the context menu.
+       // 2× is a good CPU compromise and stays the default.
+       enum SaturatorQuality {
+               QUALITY_2X,
+               QUALITY_4X,
+               QUALITY_8X,
+               QUALITY_LEN
+       };
 
-               float hissHPState = 0.f;
-               float hissBPState = 0.f;
+       // Filter coefficients follow the controls at this rate and are
+       // ramped linearly in between
+       static const int CONTROL_BLOCK = 16;
 
-               float tapeNoiseHP = 0.f;
-               float tapeNoiseBP = 0.f;
+       // Per-lane state laid out as structure-of-arrays: each member holds
+       // four channels, one group per float_4.
+       struct LaneGroup {
+               float_4 biasState = 0.f;
+               float_4 toneState = 0.f;
+               float_4 deEmphasisState = 0.f;
+               float_4 lowpassState = 0.f;
+               float_4 brightnessState = 0.f;
+               float_4 prevSaturated = 0.f;
 
                TapeAging aging;
                TapeDelayBuffer delay;
                TapeGlue glue;
 
-               float hissLP = 0.f;
-               float staticLP = 0.f;
+               TapeNoise noise;
 
+               // Last signal path output, held while the module sleeps
+               float_4 chainOut = 0.f;
+               float_4 hissGate = 1.f;
 
-               Biquad eqLow;
-               Biquad eqHigh;
-               Biquad hfComp;
-               bool eqInit = false;
 
-               float modSmoothed1 = 0.f;
-               float modSmoothed2 = 0.f;
+               TBiquad<float_4> eqLow;
+               TBiquad<float_4> eqHigh;
+               TBiquad<float_4> hfComp;
 
-               dspext::Saturator<OS_FACTOR> saturator;
-               P42Circuit transformerDark;
-               P42Circuit::MixTransformer transformerMix;
-               P42Circuit::P42CircuitSimple transformerSimple;
+               dspext::Hysteresis<float_4> hysteresis;
+               dspext::Saturator<2, float_4> saturator2;
+               dspext::Saturator<4, float_4> saturator4;
+               dspext::Saturator<8, float_4> saturator8;
+               TP42Circuit<float_4> transformerDark;
+               TP42Circuit<float_4>::MixTransformer transformerMix;
+               TP42Circuit<float_4>::P42CircuitSimple transformerSimple;
        };
 
-       ChannelState channels[2];
+       LaneGroup groups[MAX_GROUPS];
+
+       // Controls are monophonic, so every lane group shares one set of
+       // coefficients
+       ShelfCoeffCache eqLowCoeffs{false};
+       ShelfCoeffCache eqHighCoeffs{true};
+       ShelfCoeffCache hfCompCoeffs{true};
+       float toneCutoff = -1.f;
+       float toneAlpha = 0.f;
+       float toneAlphaStep = 0.f;
+       int toneRampLeft = 0;
+       int controlCounter = 0;
+       float cachedSampleRate = 0.f;
+
+       // Transport modulation is shared by every lane and advanced once per frame
+       float modSmoothed1[2] = {};
+       float modSmoothed2[2] = {};
 
        WowFlutterModulator wowFlutter;
+       // Saved with the patch so the transport renders identically on reload
+       uint32_t transportSeed = 1;
+       // Read position in every group's noise block, shared by all groups
+       int noisePos = 0;
+
+       // Stages with no audible effect are skipped and faded back in
+       static const int STAGE_FADE = 64;
+       StageFade eqFade;
+       StageFade hfCompFade;
+
+       // Sleep once the input has been silent and the signal path settled for
+       // longer than the delay and print-through buffers. While asleep each
+       // group holds its settled output and only the noise runs.
+       static const int SLEEP_FRAMES = 2 * TAPE_DELAY_BUFFER_SIZE;
+       int quietFrames = 0;
+       bool asleep = false;
+       std::array<int, 11> sleepKey = {};
 
        int tapeMode = 0; // 0: I, 1: II, 2: IV
        int tapeStyle = 2; // 0: Vintage, 1: Classic, 2: Modern (default)
@@ -374,6 +546,11 @@ struct Tape : Module {
 
        int eqCurve = 0; // 0: Bass, 1: Highs, 2: Mix
        int transformerMode = 0; // 0: Standard, 1: Dark, 2: Iron
+       int saturatorQuality = QUALITY_2X;
+       int activeSaturatorQuality = QUALITY_2X; // tier process() last ran
+       int hysteresisMode = 0; // 0: Off, then one entry per Hysteresis solver
+       int activeHysteresisMode = 0; // mode process() last ran
+       int stereoSpread = 0; // 0: Linked, 1: Subtle, 2: Wide
 
 
        struct ControlValues {
@@ -390,6 +567,8 @@ struct Tape : Module {
                float transformer = 0.f;
        };
 
+       ControlValues sleepControls;
+
        float getParamWithCv(int paramId, int cvInputId, float minValue, float maxValue, bool bipolar = false) {
                float value = params[paramId].getValue();
                if (cvInputId >= 0 && inputs[cvInputId].isConnected()) {
@@ -401,58 +580,164 @@ struct Tape : Module {
                return rack::math::clamp(value, minValue, maxValue);
        }
 
-       float processChannel(ChannelState& st, float in, const ProcessArgs& args, int channel, const ControlValues& controls) {
+       // Values shared by every lane, computed once per frame
+       struct FrameValues {
+               float biasMod = 1.f;
+               float delaySamples[2] = {};
+               float wowNoiseMod = 1.f;
+       };
+
+       FrameValues computeFrame(const ProcessArgs& args, const ControlValues& controls) {
+               FrameValues frame;
+               const SineTable& sine = SineTable::get();
+               frame.biasMod = 0.9f + 0.1f * sine(wowFlutter.getFlutterPhase() * 2.0f);
+
+               float wowAmount = controls.wow * modeWF[tapeMode];
+               float flutterAmount = controls.flutter * modeWF[tapeMode];
+               bool transportIdle = wowAmount == 0.f && flutterAmount == 0.f && wowFlutter.isSettled();
+               for (int side = 0; side < 2; side++) {
+                       transportIdle = transportIdle && std::fabs(modSmoothed1[side]) < 1e-7f && std::fabs(modSmoothed2[side]) < 1e-7f;
+               }
+               if (transportIdle) {
+                       // Stage bypass: no wow or flutter left to apply
+                       wowFlutter.advancePhases(args.sampleRate);
+                       for (int side = 0; side < 2; side++) {
+                               modSmoothed1[side] = modSmoothed2[side] = 0.f;
+                               frame.delaySamples[side] = 0.f;
+                       }
+                       frame.wowNoiseMod = 1.f + 0.05f * sine(wowFlutter.getWowPhase() * 1.5f);
+                       return frame;
+               }
+
+               float rawMod[2];
+               wowFlutter.compute(args.sampleRate, wowAmount, flutterAmount, stereoSpreadAmount[stereoSpread], rawMod);
+
+               float modDepth = 0.02f * speedModScale[tapeSpeed];
+               for (int side = 0; side < 2; side++) {
+                       modSmoothed1[side] += 0.001f * (rawMod[side] - modSmoothed1[side]);
+                       modSmoothed2[side] += 0.001f * (modSmoothed1[side] - modSmoothed2[side]);
+                       frame.delaySamples[side] = modSmoothed2[side] * modDepth * args.sampleRate;
+               }
+
+               frame.wowNoiseMod = 1.f + 0.05f * sine(wowFlutter.getWowPhase() * 1.5f);
+               return frame;
+       }
+
+
+       // Refreshes the shared filter coefficients. Targets are recomputed every
+       // CONTROL_BLOCK frames and only when their inputs changed.
+       void updateCoefficients(float sampleRate, const ControlValues& controls) {
+               if (controlCounter == 0) {
+                       float sweetDrive = controls.sweetspot;
+                       const EqCurve& curve = eqCurves[eqCurve];
+                       eqLowCoeffs.update(sampleRate, curve.lowFreq, curve.lowGainDb * sweetDrive, CONTROL_BLOCK);
+                       eqHighCoeffs.update(sampleRate, curve.highFreq, curve.highGainDb * sweetDrive, CONTROL_BLOCK);
+                       hfCompCoeffs.update(sampleRate, 12000.f, (driveMode == 2) ? 3.f : 0.f, CONTROL_BLOCK);
+
+                       bool eqOn = !(eqLowCoeffs.isFlat() && eqHighCoeffs.isFlat());
+                       if (eqFade.set(eqOn, STAGE_FADE)) {
+                               for (LaneGroup& st : groups) {
+                                       st.eqLow.reset();
+                                       st.eqHigh.reset();
+                               }
+                       }
+                       if (hfCompFade.set(!hfCompCoeffs.isFlat(), STAGE_FADE)) {
+                               for (LaneGroup& st : groups)
+                                       st.hfComp.reset();
+                       }
+
+                       if (hysteresisMode > 0) {
+                               // More bias linearizes the tape and narrows the loop
+                               float hystDrive = controls.drive / 4.f;
+                               float hystWidth = (2.5f - controls.bias) / 2.f;
+                               for (LaneGroup& st : groups)
+                                       st.hysteresis.setParams(hystDrive, hystWidth);
+                       }
+
+                       float tone = clamp(controls.tone * modeTone[tapeMode], 0.f, 1.f);
+                       float cutoff = (200.f + 20000.f * tone) * speedCutoffScale[tapeSpeed];
+                       if (cutoff != toneCutoff) {
+                               float target = clamp(onePoleCoeff(cutoff, sampleRate), 0.0001f, 0.9999f);
+                               if (toneCutoff < 0.f) {
+                                       toneAlpha = target;
+                                       toneRampLeft = 0;
+                               } else {
+                                       toneAlphaStep = (target - toneAlpha) / CONTROL_BLOCK;
+                                       toneRampLeft = CONTROL_BLOCK;
+                               }
+                               toneCutoff = cutoff;
+                       }
+               }
+               controlCounter = (controlCounter + 1) % CONTROL_BLOCK;
+
+               eqLowCoeffs.tick();
+               eqHighCoeffs.tick();
+               hfCompCoeffs.tick();
+               eqFade.tick();
+               hfCompFade.tick();
+               if (toneRampLeft > 0) {
+                       toneAlpha += toneAlphaStep;
+                       toneRampLeft--;
+               }
+       }
+
+       // side selects the left (0) or right (1) transport modulation
+       float_4 processGroup(LaneGroup& st, int side, float_4 in, const ProcessArgs& args, const ControlValues& controls, const FrameValues& frame) {
                float inputGain = controls.inputGain;
                float drive = controls.drive;
 
                float userBias = controls.bias;
                float biasAmount = modeBias[tapeMode] * userBias;
 
-               float biasMod = 0.9f + 0.1f * std::sin(2.f * M_PI * wowFlutter.getFlutterPhase() * 2.0f);
-               float biasFiltered = st.biasState + 0.2f * (in - st.biasState);
+               float_4 biasFiltered = st.biasState + 0.2f * (in - st.biasState);
                st.biasState = biasFiltered;
-               float preFiltered = in + biasFiltered * biasAmount * biasMod;
+               float_4 preFiltered = in + biasFiltered * (biasAmount * frame.biasMod);
 
-               float driven = preFiltered * inputGain;
+               float_4 driven = preFiltered * inputGain;
+
+               // Magnetic hysteresis between bias and playback
+               if (hysteresisMode > 0)
+                       driven = st.hysteresis.process(driven, static_cast<dspext::Hysteresis<float_4>::Solver>(hysteresisMode - 1));
 
                // Drive knob controls additional tape saturation
                float driveScaled = drive * modeDrive[tapeMode];
                float satDrive = driveScaled;
 
-               st.saturator.mix = modeSaturatorMix[driveMode];
-               auto circuit = static_cast<dspext::Saturator<OS_FACTOR>::Circuit>(modeSaturatorCircuit[driveMode]);
-               float saturated = st.saturator.process(driven, satDrive, args.sampleRate, circuit);
+               float satMix = modeSaturatorMix[driveMode];
+               auto circuit = static_cast<dspext::SaturatorBase::Circuit>(modeSaturatorCircuit[driveMode]);
+               float_4 saturated;
+               switch (saturatorQuality) {
+                       case QUALITY_8X:
+                               st.saturator8.mix = satMix;
+                               saturated = st.saturator8.process(driven, satDrive, circuit);
+                               break;
+                       case QUALITY_4X:
+                               st.saturator4.mix = satMix;
+                               saturated = st.saturator4.process(driven, satDrive, circuit);
+                               break;
+                       default:
+                               st.saturator2.mix = satMix;
+                               saturated = st.saturator2.process(driven, satDrive, circuit);
+                               break;
+               }
 
-               float warmTail = 0.02f * st.prevSaturated;
+               float_4 warmTail = 0.02f * st.prevSaturated;
                st.prevSaturated = saturated;
-               float saturatedWithTail = saturated + warmTail;
+               float_4 saturatedWithTail = saturated + warmTail;
 
                // Glue compression responds to the input level
                float glueAmount = std::max(0.f, inputGain - 1.f) * modeGlue[tapeMode];
-               float glued = st.glue.process(saturatedWithTail, glueAmount, driveMode, driven);
-
-               float wowAmount = controls.wow * modeWF[tapeMode];
-               float flutterAmount = controls.flutter * modeWF[tapeMode];
-               float rawMod = wowFlutter.compute(args.sampleRate, wowAmount, flutterAmount);
-
-               st.modSmoothed1 += 0.001f * (rawMod - st.modSmoothed1);
-               st.modSmoothed2 += 0.001f * (st.modSmoothed1 - st.modSmoothed2);
+               float_4 glued = st.glue.process(saturatedWithTail, glueAmount, driveMode, driven);
 
-               float modDepth = 0.02f * speedModScale[tapeSpeed];
-               float delaySamples = st.modSmoothed2 * modDepth * args.sampleRate;
-
-               // Use separate delay lines per channel to avoid cross-talk
-               float delayed = st.delay.readModulated(glued, delaySamples, channel, args.sampleRate);
+               // Each lane group has its own delay line to avoid cross-talk
+               float_4 delayed = st.delay.readModulated(glued, frame.delaySamples[side], args.sampleRate);
 
                float tone = controls.tone * modeTone[tapeMode];
                tone = clamp(tone, 0.f, 1.f);
-               float cutoff = 200.f + 20000.f * tone;
-               cutoff *= speedCutoffScale[tapeSpeed];
-               float alpha = std::exp(-2.f * M_PI * cutoff / args.sampleRate);
-               alpha = clamp(alpha, 0.0001f, 0.9999f);
+               float alpha = toneAlpha;
                st.toneState = alpha * st.toneState + (1.f - alpha) * delayed;
 
-               float deEmphasized = st.toneState * st.aging.eqDrift + 0.04f * (st.deEmphasisState - st.toneState);
+               float_4 deEmphasized = st.toneState * st.aging.eqDrift + 0.04f * (st.deEmphasisState - st.toneState);
                st.deEmphasisState = st.toneState;
 
                float bumpSensitivity = 0.4f * modeBump[tapeMode];
@@ -461,97 +746,105 @@ struct Tape : Module {
                float bumpIntensity = std::max(0.f, (inputGain * drive - bumpThreshold) * bumpSensitivity);
                st.lowpassState += 0.05f * (deEmphasized - st.lowpassState);
 
-               float highpassEstimate = deEmphasized - st.lowpassState;
-               if (std::abs(highpassEstimate) < 0.1f)
-                       bumpIntensity *= 0.5f;
+               float_4 highpassEstimate = deEmphasized - st.lowpassState;
+               float_4 bumpLane = simd::ifelse(simd::fabs(highpassEstimate) < 0.1f,
+                                               rack::math::clamp(0.5f * bumpIntensity, 0.f, 1.f),
+                                               rack::math::clamp(bumpIntensity, 0.f, 1.f));
 
-               bumpIntensity = rack::math::clamp(bumpIntensity, 0.f, 1.f);
+               float_4 lowBump = deEmphasized + (st.lowpassState - deEmphasized) * bumpLane;
 
-               float lowBump = deEmphasized + (st.lowpassState - deEmphasized) * bumpIntensity;
+               float_4 bassRestore = lowBump + 0.1f * (lowBump - st.lowpassState);
 
-               float bassRestore = lowBump + 0.1f * (lowBump - st.lowpassState);
+               float_4 toneTrim = 1.0f - 0.02f * tanhExp(driven * 0.3f);
+               float_4 signal = bassRestore * toneTrim;
 
-               float toneTrim = 1.0f - 0.02f * std::tanh(driven * 0.3f);
-               float signal = bassRestore * toneTrim;
-
-               float highComponent = signal - st.brightnessState;
+               float_4 highComponent = signal - st.brightnessState;
                float biasTilt = userBias - 1.f;
                float highBoost = fmaxf(biasTilt, 0.f) * 3.6f;
                float lowBoost  = fmaxf(-biasTilt, 0.f) * 1.6f;
 
-               float finalBrightness = signal + (0.1f + highBoost) * highComponent;
+               float_4 finalBrightness = signal + (0.1f + highBoost) * highComponent;
                finalBrightness += lowBoost * (st.lowpassState - signal);
                st.brightnessState = signal;
 
-               if (!st.eqInit) {
-                       st.eqLow.reset();
-                       st.eqHigh.reset();
-                       st.hfComp.reset();
-                       st.eqInit = true;
+               float_4 eqProcessed = finalBrightness;
+               if (eqFade.active) {
+                       float_4 shelved = st.eqHigh.process(st.eqLow.process(finalBrightness, eqLowCoeffs.current), eqHighCoeffs.current);
+                       eqProcessed = eqFade.apply(finalBrightness, shelved);
                }
-               float sweetDrive = controls.sweetspot;
-               float lowGain = eqCurves[eqCurve].lowGainDb * sweetDrive;
-               float highGain = eqCurves[eqCurve].highGainDb * sweetDrive;
-               st.eqLow.setLowShelf(args.sampleRate, eqCurves[eqCurve].lowFreq, lowGain);
-               st.eqHigh.setHighShelf(args.sampleRate, eqCurves[eqCurve].highFreq, highGain);
-               float eqProcessed = st.eqHigh.process(st.eqLow.process(finalBrightness));
-
-               float hfCompGain = (driveMode == 2) ? 3.f : 0.f;
-               st.hfComp.setHighShelf(args.sampleRate, 12000.f, hfCompGain);
-               float hfProcessed = st.hfComp.process(eqProcessed);
-
-               float hissAmount = controls.hiss;
-               float white = 2.f * random::uniform() - 1.f;
-
-               float hp = white - st.hissHPState;
-               st.hissHPState = white;
-
-               float bp = hp - st.hissBPState * 0.9f;
-               st.hissBPState = bp;
-
-               float hissShaped = bp * 1.5f;
-               float hissScale = modeHiss[tapeMode];
-               float hissSignal = hissShaped * hissAmount * hissScale * 2.f * styleNoiseScale[tapeStyle] * speedNoiseScale[tapeSpeed];
-
-               st.hissLP += 0.05f * (hissSignal - st.hissLP);
-               hissSignal = st.hissLP;
-               if (std::abs(eqProcessed) < 0.01f)
-                       hissSignal *= 0.25f;
-
-               float hissToneTrim = 1.0f - 0.6f * (1.0f - tone);
-               hissSignal *= hissToneTrim;
-
-               float noiseAmount = controls.noise;
-               float tapeWhite = 2.f * random::uniform() - 1.f;
-               float noiseHP = tapeWhite - st.tapeNoiseHP;
-               st.tapeNoiseHP = tapeWhite;
-               float noiseBP = noiseHP - st.tapeNoiseBP * 0.85f;
-               st.tapeNoiseBP = noiseBP;
-
-               float wowNoiseMod = 1.f + 0.05f * std::sin(2.f * M_PI * wowFlutter.getWowPhase() * 1.5f);
-               float tapeStatic = noiseBP * 0.8f * wowNoiseMod * noiseAmount * modeStatic[tapeMode] * 2.f * styleNoiseScale[tapeStyle] * speedNoiseScale[tapeSpeed];
-
-               st.staticLP += 0.03f * (tapeStatic - st.staticLP);
-               tapeStatic = st.staticLP;
-               tapeStatic *= 0.9f;
+               float_4 hfProcessed = eqProcessed;
+               if (hfCompFade.active)
+                       hfProcessed = hfCompFade.apply(eqProcessed, st.hfComp.process(eqProcessed, hfCompCoeffs.current));
+               st.hissGate = simd::ifelse(simd::fabs(eqProcessed) < 0.01f, 0.25f, 1.f);
 
                float level = controls.level;
                st.aging.storePrint(glued);
-               float printEcho = st.aging.getPrintEcho(args.sampleRate);
+               float_4 printEcho = st.aging.getPrintEcho(args.sampleRate);
                float xformDrive = controls.transformer;
-               float transformed = 0.f;
+               float_4 transformed = 0.f;
                switch (transformerMode) {
                        case 1:
-                               transformed = st.transformerDark.process(hfProcessed, 1.f + xformDrive, args.sampleRate);
+                               transformed = st.transformerDark.process(hfProcessed, 1.f + xformDrive);
                                break;
                        case 2:
-                               transformed = st.transformerMix.process(hfProcessed, 1.f + xformDrive, args.sampleRate);
+                               transformed = st.transformerMix.process(hfProcessed, 1.f + xformDrive);
                                break;
                        default:
-                               transformed = st.transformerSimple.process(hfProcessed, 1.f + xformDrive, args.sampleRate);
+                               transformed = st.transformerSimple.process(hfProcessed, 1.f + xformDrive);
                                break;
                }
-               return transformed * level + hissSignal + tapeStatic + printEcho;
+               return transformed * level + printEcho;
+       }
+
+       float_4 processNoise(LaneGroup& st, const ControlValues& controls, const FrameValues& frame) {
+               // Noise buffers are refilled at block starts, and only for the
+               // sources that are audible
+               float noiseScale = 2.f * styleNoiseScale[tapeStyle] * speedNoiseScale[tapeSpeed];
+               float hissGain = controls.hiss * modeHiss[tapeMode] * noiseScale;
+               float staticGain = 0.8f * frame.wowNoiseMod * controls.noise * modeStatic[tapeMode] * noiseScale;
+               if (noisePos == 0) {
+                       if (hissGain > 0.f)
+                               st.noise.fillHiss();
+                       if (staticGain > 0.f)
+                               st.noise.fillStatic();
+               }
+
+               float_4 hissSignal = 0.f;
+               if (hissGain > 0.f) {
+                       hissSignal = st.noise.hiss[noisePos] * hissGain;
+                       hissSignal *= st.hissGate;
+
+                       float tone = clamp(controls.tone * modeTone[tapeMode], 0.f, 1.f);
+                       float hissToneTrim = 1.0f - 0.6f * (1.0f - tone);
+                       hissSignal *= hissToneTrim;
+               }
+
+               float_4 tapeStatic = 0.f;
+               if (staticGain > 0.f)
+                       tapeStatic = st.noise.tapeStatic[noisePos] * staticGain;
+
+               return hissSignal + tapeStatic;
+       }
+
+       // Everything that must match for a sleeping module to stay asleep
+       std::array<int, 11> makeSleepKey(int channels, bool stereo) const {
+               return {channels, stereo, tapeMode, tapeStyle, driveMode, tapeSpeed, eqCurve,
+                       transformerMode, saturatorQuality, hysteresisMode, stereoSpread};
+       }
+
+       // Runs one lane group and returns its output. Outside of sleep it also
+       // reports whether the signal path output moved this frame.
+       float_4 runGroup(LaneGroup& st, int side, float_4 in, const ProcessArgs& args, const ControlValues& controls, const FrameValues& frame, bool& settled) {
+               if (asleep) {
+                       st.delay.track(frame.delaySamples[side], args.sampleRate);
+                       return st.chainOut + processNoise(st, controls, frame);
+               }
+               float_4 prev = st.chainOut;
+               float_4 chain = processGroup(st, side, in, args, controls, frame);
+               st.chainOut = chain;
+               if (simd::movemask(simd::fabs(chain - prev) > 1e-7f))
+                       settled = false;
+               return chain + processNoise(st, controls, frame);
        }
 	
 
@@ -594,13 +887,46 @@ struct Tape : Module {
                configInput(NOISE_CV_INPUT, "Noise CV");
                configInput(SWEETSPOT_CV_INPUT, "Sweetspot CV");
                configInput(TRANSFORM_CV_INPUT, "Transformer Load CV");
+
+               seedRandom(random::u32());
+
+               onSampleRateChange();
+       }
+
+       // Seeds the transport and every group's noise from one saved value
+       void seedRandom(uint32_t seed) {
+               transportSeed = seed;
+               wowFlutter.seed(seed);
+               for (int g = 0; g < MAX_GROUPS; g++)
+                       groups[g].noise.seed(seed + 0x9E3779B9u * (g + 1));
+       }
+
+       void onSampleRateChange() override {
+               setSampleRate(APP ? APP->engine->getSampleRate() : 44100.f);
+       }
+
+       // Fixed-cutoff filters are precomputed here; the shelves and tone
+       // filter are refreshed from scratch on the next control block.
+       void setSampleRate(float sampleRate) {
+               cachedSampleRate = sampleRate;
+               for (LaneGroup& st : groups) {
+                       st.transformerDark.setSampleRate(sampleRate);
+                       st.transformerMix.setSampleRate(sampleRate);
+                       st.transformerSimple.setSampleRate(sampleRate);
+                       st.hysteresis.setSampleRate(sampleRate);
+                       st.saturator2.setSampleRate(sampleRate);
+                       st.saturator4.setSampleRate(sampleRate);
+                       st.saturator8.setSampleRate(sampleRate);
+               }
+               toneCutoff = -1.f;
+               controlCounter = 0;
        }
 
         void process(const ProcessArgs& args) override {
                 constexpr float VOLT_SCALE = 0.2f;
 
-                float inL = inputs[LEFT_INPUT].getVoltage() * VOLT_SCALE;
-                float inR = inputs[RIGHT_INPUT].isConnected() ? inputs[RIGHT_INPUT].getVoltage() * VOLT_SCALE : inL;
+                int channels = std::max({1, inputs[LEFT_INPUT].getChannels(), inputs[RIGHT_INPUT].getChannels()});
+                bool rightConnected = inputs[RIGHT_INPUT].isConnected();
                 bool stereo = outputs[RIGHT_OUTPUT].isConnected();
 
                 ControlValues controls;
@@ -616,18 +942,85 @@ struct Tape : Module {
                 controls.sweetspot = getParamWithCv(SWEETSPOT_PARAM, SWEETSPOT_CV_INPUT, -1.f, 1.f, true);
                 controls.transformer = getParamWithCv(TRANSFORM_PARAM, TRANSFORM_CV_INPUT, 0.f, 5.f);
 
-                // SAFER: average pre-process if mono
-                if (!stereo) {
-                        float mono = 0.5f * (inL + inR);
-                        float out = processChannel(channels[0], mono, args, 0, controls);
-                        outputs[LEFT_OUTPUT].setVoltage(out / VOLT_SCALE);
-                        outputs[RIGHT_OUTPUT].setVoltage(0.f); // optional mute
-                } else {
-                        float outL = processChannel(channels[0], inL, args, 0, controls);
-                        float outR = processChannel(channels[1], inR, args, 1, controls);
-                        outputs[LEFT_OUTPUT].setVoltage(outL / VOLT_SCALE);
-                        outputs[RIGHT_OUTPUT].setVoltage(outR / VOLT_SCALE);
+                if (args.sampleRate != cachedSampleRate)
+                        setSampleRate(args.sampleRate);
+                updateCoefficients(args.sampleRate, controls);
+
+                // A tier switched back in would resume from the resampler and
+                // filter history it had when it was last left, so it starts clean
+                if (saturatorQuality != activeSaturatorQuality) {
+                        for (LaneGroup& st : groups) {
+                                switch (saturatorQuality) {
+                                        case QUALITY_8X:
+                                                st.saturator8.reset();
+                                                break;
+                                        case QUALITY_4X:
+                                                st.saturator4.reset();
+                                                break;
+                                        default:
+                                                st.saturator2.reset();
+                                                break;
+                                }
+                        }
+                        activeSaturatorQuality = saturatorQuality;
+                }
+                // Likewise the hysteresis model when it is switched back on
+                if (hysteresisMode != activeHysteresisMode) {
+                        if (activeHysteresisMode == 0) {
+                                for (LaneGroup& st : groups)
+                                        st.hysteresis.reset();
+                        }
+                        activeHysteresisMode = hysteresisMode;
+                }
+
+                FrameValues frame = computeFrame(args, controls);
+
+                outputs[LEFT_OUTPUT].setChannels(channels);
+                outputs[RIGHT_OUTPUT].setChannels(channels);
+
+                float_4 inL[GROUPS_PER_SIDE];
+                float_4 inR[GROUPS_PER_SIDE];
+                bool silent = true;
+                for (int c = 0; c < channels; c += 4) {
+                        int g = c / 4;
+                        inL[g] = inputs[LEFT_INPUT].getPolyVoltageSimd<float_4>(c) * VOLT_SCALE;
+                        inR[g] = rightConnected ? inputs[RIGHT_INPUT].getPolyVoltageSimd<float_4>(c) * VOLT_SCALE : inL[g];
+                        if (simd::movemask((simd::fabs(inL[g]) > 1e-6f) | (simd::fabs(inR[g]) > 1e-6f)))
+                                silent = false;
                 }
+
+                std::array<int, 11> key = makeSleepKey(channels, stereo);
+                if (asleep && (!silent || key != sleepKey || std::memcmp(&controls, &sleepControls, sizeof(ControlValues)) != 0)) {
+                        asleep = false;
+                        quietFrames = 0;
+                }
+
+                bool settled = true;
+                for (int c = 0; c < channels; c += 4) {
+                        int g = c / 4;
+                        // SAFER: average pre-process if mono
+                        if (!stereo) {
+                                float_4 mono = 0.5f * (inL[g] + inR[g]);
+                                float_4 out = runGroup(groups[g], 0, mono, args, controls, frame, settled);
+                                outputs[LEFT_OUTPUT].setVoltageSimd(out / VOLT_SCALE, c);
+                                outputs[RIGHT_OUTPUT].setVoltageSimd(float_4(0.f), c); // optional mute
+                        } else {
+                                float_4 outL = runGroup(groups[g], 0, inL[g], args, controls, frame, settled);
+                                float_4 outR = runGroup(groups[GROUPS_PER_SIDE + g], 1, inR[g], args, controls, frame, settled);
+                                outputs[LEFT_OUTPUT].setVoltageSimd(outL / VOLT_SCALE, c);
+                                outputs[RIGHT_OUTPUT].setVoltageSimd(outR / VOLT_SCALE, c);
+                        }
+                }
+
+                if (!asleep) {
+                        quietFrames = (silent && settled) ? quietFrames + 1 : 0;
+                        if (quietFrames >= SLEEP_FRAMES) {
+                                asleep = true;
+                                sleepKey = key;
+                                sleepControls = controls;
+                        }
+                }
+                noisePos = (noisePos + 1) % TapeNoise::BLOCK;
         }
 
         json_t* dataToJson() override {
@@ -638,6 +1031,10 @@ struct Tape : Module {
                 json_object_set_new(root, "tapeSpeed", json_integer(tapeSpeed));
                 json_object_set_new(root, "eqCurve", json_integer(eqCurve));
                 json_object_set_new(root, "transformerMode", json_integer(transformerMode));
+                json_object_set_new(root, "saturatorQuality", json_integer(saturatorQuality));
+                json_object_set_new(root, "hysteresisMode", json_integer(hysteresisMode));
+                json_object_set_new(root, "stereoSpread", json_integer(stereoSpread));
+                json_object_set_new(root, "transportSeed", json_integer(transportSeed));
 
                 return root;
         }
@@ -668,6 +1065,22 @@ struct Tape : Module {
                 if (xformJ) {
                                 transformerMode = json_integer_value(xformJ);
                 }
+                json_t* qualityJ = json_object_get(root, "saturatorQuality");
+                if (qualityJ) {
+                                saturatorQuality = clamp((int)json_integer_value(qualityJ), 0, QUALITY_LEN - 1);
+                }
+                json_t* spreadJ = json_object_get(root, "stereoSpread");
+                if (spreadJ) {
+                                stereoSpread = clamp((int)json_integer_value(spreadJ), 0, 2);
+                }
+                json_t* seedJ = json_object_get(root, "transportSeed");
+                if (seedJ) {
+                                seedRandom((uint32_t)json_integer_value(seedJ));
+                }
+                json_t* hystJ = json_object_get(root, "hysteresisMode");
+                if (hystJ) {
+                                hysteresisMode = clamp((int)json_integer_value(hystJ), 0, (int)dspext::Hysteresis<float_4>::SOLVERS_LEN);
+                }
         }
 };
 
@@ -761,6 +1174,27 @@ struct TapeWidget : ModuleWidget {
                         {"Standard", "Dark", "Iron"},
                         &module->transformerMode
                 ));
+                menu->addChild(createIndexPtrSubmenuItem("Stereo Wow/Flutter",
+                        {"Linked", "Subtle", "Wide"},
+                        &module->stereoSpread
+                ));
+                menu->addChild(createIndexPtrSubmenuItem("Saturation Quality",
+                        {"2× (lowest CPU)", "4×", "8× (highest CPU)"},
+                        &module->saturatorQuality
+                ));
+
+                // Solver tiers list their cost in model evaluations per sample
+                using Hyst = dspext::Hysteresis<float_4>;
+                auto solverLabel = [](const std::string& name, Hyst::Solver solver) {
+                        return name + " (" + std::to_string(Hyst::evalsPerSample(solver)) + " evals/sample)";
+                };
+                menu->addChild(createIndexPtrSubmenuItem("Hysteresis",
+                        {"Off",
+                         solverLabel("RK2", Hyst::RK2),
+                         solverLabel("RK4", Hyst::RK4),
+                         solverLabel("Newton-Raphson", Hyst::NEWTON_RAPHSON)},
+                        &module->hysteresisMode
+                ));
         }
 };
 
@@ -1,7 +1,11 @@
 #include "plugin.hpp"
+#include "XezbethBus.hpp"
+#include "dsp/ChannelStrip.hpp"
+#include "dsp/Loudness.hpp"
+#include <dsp/resampler.hpp>
 #include <algorithm>
-#include <array>
 #include <cmath>
+#include <cstdio>
 #include <initializer_list>
 #include <string>
 
@@ -13,6 +17,7 @@ using rack::createLightCentered;
 using rack::createOutputCentered;
 using rack::createParamCentered;
 using rack::createWidget;
+using rack::simd::float_4;
 
 static inline float dbToGain(float db) {
         if (db <= -80.f)
@@ -26,14 +31,59 @@ static inline float amplitudeToDb(float amp) {
         return 20.f * std::log10(amp);
 }
 
-struct MeterState {
-        float rms = 0.f;
-        float truePeak = 0.f;
-        float peakHold = 0.f;
-        float peakHoldTimer = 0.f;
-        float clipTimer = 0.f;
-        double prevL = 0.0;
-        double prevR = 0.0;
+// Neve-style drive curve on normalized samples. L and R are lanes 0 and 1,
+// lanes 2 and 3 are scratch. env follows the level at the rate the curve
+// runs at.
+struct DriveShaper {
+        float drive = 0.f;
+        float evenWeight = 0.5f;
+        float oddWeight = 0.5f;
+        float evenBias = 0.18f;
+
+        float_4 operator()(float_4 x, float_4& env) const {
+                env += 0.04f * (rack::simd::fabs(x) - env);
+                env = rack::simd::clamp(env, 0.f, 2.f);
+                float_4 dynamicDrive = drive * (1.f + 0.6f * env);
+
+                float_4 odd = x - (x * x * x) * (1.f / 3.f);
+                // Both tanh terms of L and R in one call: lanes 0-1 take the
+                // biased signal, lanes 2-3 the bias alone
+                float_4 driven = (x + evenBias) * dynamicDrive;
+                float_4 bias = evenBias * dynamicDrive;
+                float_4 t = tanhExp(float_4(_mm_movelh_ps(driven.v, bias.v)));
+                float_4 even = t - float_4(_mm_movehl_ps(t.v, t.v));
+
+                float_4 mix = oddWeight * odd + evenWeight * even;
+                return mix / (1.f + rack::simd::fabs(mix) * 0.25f);
+        }
+};
+
+// Polyphase FIR up/down pair running the drive curve at OS times the rate
+template <int OS>
+struct DriveResampler {
+        rack::dsp::Upsampler<OS, 8, float_4> upsampler;
+        rack::dsp::Decimator<OS, 8, float_4> decimator;
+
+        void reset() {
+                upsampler.reset();
+                decimator.reset();
+        }
+
+        // Fills both filter histories as if x had been held for the whole
+        // FIR length, so a resampler that sat idle resumes without a dip
+        void prime(float_4 x, const DriveShaper& shaper, float_4 env) {
+                reset();
+                for (int i = 0; i < 8; ++i)
+                        process(x, shaper, env);
+        }
+
+        float_4 process(float_4 x, const DriveShaper& shaper, float_4& env) {
+                alignas(16) float_4 buf[OS];
+                upsampler.process(x, buf);
+                for (int i = 0; i < OS; ++i)
+                        buf[i] = shaper(buf[i], env);
+                return decimator.process(buf);
+        }
 };
 
 struct Xezbeth4X : rack::engine::Module {
@@ -114,10 +164,17 @@ struct Xezbeth4X : rack::engine::Module {
                 PAN_MINUS6
         };
 
+        // Loudness shown by the meter bars
         enum MeterResponse {
-                RESPONSE_FAST = 0,
-                RESPONSE_MEDIUM,
-                RESPONSE_SLOW
+                RESPONSE_MOMENTARY = 0,
+                RESPONSE_SHORT_TERM,
+                RESPONSE_INTEGRATED
+        };
+
+        // Meter points in the loudness bank: channels 1-4, master, PFL
+        enum MeterPoint {
+                METER_MASTER = 4,
+                METER_PFL = 5
         };
 
         enum HeadroomModel {
@@ -125,9 +182,19 @@ struct Xezbeth4X : rack::engine::Module {
                 HEADROOM_EXTENDED
         };
 
-        std::array<MeterState, 4> channelMeters{};
-        MeterState masterMeter{};
-        MeterState pflMeter{};
+        // BS.1770 loudness and true peak for all meter points; the meter
+        // widgets read its published values
+        dspext::LoudnessMeterBank meters;
+
+        // Trim and pan gains of the four strips
+        dspext::ChannelStrip4 strips;
+        float masterTrimDb = 0.f;
+        float masterTrimGain = 1.f;
+
+        // Pre-summed channels of the expanders chained to the right
+        XezbethBus::ToMixer chainMessages[2]{};
+        // Own strips held back by the chain length, see XezbethBus.hpp
+        XezbethBus::SumDelay ownDelay;
 
         float lowShelfStateL = 0.f;
         float lowShelfStateR = 0.f;
@@ -136,10 +203,13 @@ struct Xezbeth4X : rack::engine::Module {
         float lowShelfAlpha = 0.f;
         float highShelfAlpha = 0.f;
 
-        double drivePrevL = 0.0;
-        double drivePrevR = 0.0;
-        float driveEnvL = 0.f;
-        float driveEnvR = 0.f;
+        // Master bus drive, L/R in lanes 0 and 1
+        float_4 driveEnv = 0.f;
+        DriveResampler<2> drive2x;
+        DriveResampler<4> drive4x;
+        DriveResampler<8> drive8x;
+        int driveOversample = 1;
+        bool driveRunning = false; // drive ran on the previous sample
 
         int summingStyle = SUMMING_CLEAN;
         int harmonicDrive = DRIVE_OFF;
@@ -147,7 +217,7 @@ struct Xezbeth4X : rack::engine::Module {
         int oversamplingQuality = OS_1X;
         int panLawSetting = PAN_MINUS3;
         bool meterPeakHold = true;
-        int meterResponse = RESPONSE_MEDIUM;
+        int meterResponse = RESPONSE_MOMENTARY;
         int headroomMode = HEADROOM_STANDARD;
         bool clipSafeEnabled = true;
 
@@ -177,6 +247,9 @@ struct Xezbeth4X : rack::engine::Module {
                 configOutput(POST_OUTPUT_L, "Post record left");
                 configOutput(POST_OUTPUT_R, "Post record right");
 
+                rightExpander.producerMessage = &chainMessages[0];
+                rightExpander.consumerMessage = &chainMessages[1];
+
                 onSampleRateChange();
         }
 
@@ -186,17 +259,18 @@ struct Xezbeth4X : rack::engine::Module {
                 const float highCut = 7500.f;
                 lowShelfAlpha = std::exp(-2.f * M_PI * lowCut / sr);
                 highShelfAlpha = std::exp(-2.f * M_PI * highCut / sr);
+                meters.setSampleRate(sr);
         }
 
-        float getPanCenterGain() const {
+        float getPanCenterDb() const {
                 switch (panLawSetting) {
                         default:
                         case PAN_MINUS3:
-                                return std::pow(10.f, -3.f / 20.f);
+                                return -3.f;
                         case PAN_MINUS4_5:
-                                return std::pow(10.f, -4.5f / 20.f);
+                                return -4.5f;
                         case PAN_MINUS6:
-                                return std::pow(10.f, -6.f / 20.f);
+                                return -6.f;
                 }
         }
 
@@ -218,72 +292,9 @@ struct Xezbeth4X : rack::engine::Module {
                 switch (headroomMode) {
                         default:
                         case HEADROOM_STANDARD:
-                                return std::pow(10.f, 24.f / 20.f);
+                                return 15.848932f; // +24 dB
                         case HEADROOM_EXTENDED:
-                                return std::pow(10.f, 30.f / 20.f);
-                }
-        }
-
-        void updateMeter(MeterState& meter, float left, float right, float sampleTime) {
-                float energy = 0.5f * (left * left + right * right);
-                float inst = std::sqrt(std::max(energy, 0.f));
-
-                float tau = 0.075f;
-                switch (meterResponse) {
-                        case RESPONSE_FAST:
-                                tau = 0.03f;
-                                break;
-                        case RESPONSE_MEDIUM:
-                                tau = 0.075f;
-                                break;
-                        case RESPONSE_SLOW:
-                                tau = 0.3f;
-                                break;
-                }
-                float alpha = std::exp(-sampleTime / tau);
-                meter.rms = rack::math::crossfade(inst, meter.rms, alpha);
-
-                const int oversample = 4;
-                double curL = left;
-                double curR = right;
-                double prevL = meter.prevL;
-                double prevR = meter.prevR;
-                double maxMag = std::max(std::fabs(curL), std::fabs(curR));
-                for (int i = 1; i < oversample; ++i) {
-                        double t = static_cast<double>(i) / oversample;
-                        double interpL = prevL + (curL - prevL) * t;
-                        double interpR = prevR + (curR - prevR) * t;
-                        double mag = std::max(std::fabs(interpL), std::fabs(interpR));
-                        if (mag > maxMag)
-                                maxMag = mag;
-                }
-                meter.prevL = curL;
-                meter.prevR = curR;
-                meter.truePeak = static_cast<float>(maxMag);
-
-                if (meterPeakHold) {
-                        if (maxMag >= meter.peakHold) {
-                                meter.peakHold = static_cast<float>(maxMag);
-                                meter.peakHoldTimer = 0.f;
-                        } else {
-                                meter.peakHoldTimer += sampleTime;
-                                const float holdTime = 0.6f;
-                                if (meter.peakHoldTimer > holdTime) {
-                                        float decay = std::exp(-sampleTime / 0.2f);
-                                        meter.peakHold *= decay;
-                                        if (meter.peakHold < meter.truePeak)
-                                                meter.peakHold = meter.truePeak;
-                                }
-                        }
-                } else {
-                        meter.peakHold = meter.truePeak;
-                        meter.peakHoldTimer = 0.f;
-                }
-
-                if (maxMag >= 1.f) {
-                        meter.clipTimer = 0.18f;
-                } else {
-                        meter.clipTimer = std::max(0.f, meter.clipTimer - sampleTime);
+                                return 31.622777f; // +30 dB
                 }
         }
 
@@ -310,131 +321,137 @@ struct Xezbeth4X : rack::engine::Module {
                 return {liftedL, liftedR};
         }
 
-        float processDriveSample(float input, double& prev, float& env, int oversample, float driveBase,
-                                 float evenWeight, float oddWeight, float evenBias, float headroom) {
-                if (driveBase <= 0.f) {
-                        prev = input / headroom;
-                        return input;
+        float_4 processDrive(float_4 input, int oversample, const DriveShaper& shaper, float headroom) {
+                float_4 normalized = rack::simd::clamp(input / headroom, -4.f, 4.f);
+
+                // Stale filter history would click when switching factors or
+                // when drive comes back on after the resamplers sat idle, so
+                // the one about to run is primed with the current input
+                if (oversample != driveOversample || !driveRunning) {
+                        switch (oversample) {
+                                case 2:
+                                        drive2x.prime(normalized, shaper, driveEnv);
+                                        break;
+                                case 4:
+                                        drive4x.prime(normalized, shaper, driveEnv);
+                                        break;
+                                case 8:
+                                        drive8x.prime(normalized, shaper, driveEnv);
+                                        break;
+                        }
+                        driveOversample = oversample;
+                        driveRunning = true;
                 }
 
-                double normalized = static_cast<double>(input) / headroom;
-                normalized = static_cast<double>(rack::math::clamp(static_cast<float>(normalized), -4.f, 4.f));
-
-                double last = prev;
-                double acc = 0.0;
-
-                for (int i = 0; i < oversample; ++i) {
-                        double t = static_cast<double>(i + 1) / oversample;
-                        double interp = last + (normalized - last) * t;
-                        float absInterp = static_cast<float>(std::fabs(interp));
-                        env += 0.04f * (absInterp - env);
-                        env = rack::math::clamp(env, 0.f, 2.f);
-                        float dynamicDrive = driveBase * (1.f + 0.6f * env);
-
-                        double odd = interp - (interp * interp * interp) * (1.0 / 3.0);
-                        double even = std::tanh((interp + evenBias) * dynamicDrive);
-                        even -= std::tanh(evenBias * dynamicDrive);
-
-                        double mix = oddWeight * odd + evenWeight * even;
-                        double limited = mix / (1.0 + std::fabs(mix) * 0.25);
-                        acc += limited;
+                float_4 out;
+                switch (oversample) {
+                        default:
+                                out = shaper(normalized, driveEnv);
+                                break;
+                        case 2:
+                                out = drive2x.process(normalized, shaper, driveEnv);
+                                break;
+                        case 4:
+                                out = drive4x.process(normalized, shaper, driveEnv);
+                                break;
+                        case 8:
+                                out = drive8x.process(normalized, shaper, driveEnv);
+                                break;
                 }
-
-                prev = normalized;
-                double averaged = acc / oversample;
-                averaged = static_cast<double>(rack::math::clamp(static_cast<float>(averaged), -4.f, 4.f));
-                return static_cast<float>(averaged * headroom);
-        }
-
-        std::pair<float, float> applyPan(float inL, float inR, float pan, float centerGain) {
-                const float width = 0.5f;
-                auto computeGains = [centerGain](float value) {
-                        value = rack::math::clamp(value, -1.f, 1.f);
-                        float angle = (value + 1.f) * (float)M_PI * 0.25f;
-                        float left = std::cos(angle);
-                        float right = std::sin(angle);
-                        float scale = centerGain / std::sqrt(0.5f);
-                        left *= scale;
-                        right *= scale;
-                        return std::pair<float, float>(left, right);
-                };
-
-                auto gainsL = computeGains(pan - width);
-                auto gainsR = computeGains(pan + width);
-
-                float outL = inL * gainsL.first + inR * gainsR.first;
-                float outR = inL * gainsL.second + inR * gainsR.second;
-                return {outL, outR};
+                return rack::simd::clamp(out, -4.f, 4.f) * headroom;
         }
 
         void process(const ProcessArgs& args) override {
-                const float sampleTime = args.sampleTime;
-                const float centerGain = getPanCenterGain();
                 const int oversample = getOversampleFactor();
                 const float headroom = getHeadroom();
 
-                bool anySolo = false;
-                std::array<bool, 4> soloStates{};
-                for (int i = 0; i < 4; ++i) {
-                        bool solo = params[CHANNEL_SOLO_PARAM + i].getValue() > 0.5f;
-                        soloStates[i] = solo;
-                        anySolo = anySolo || solo;
+                rack::engine::Module* rightModule = getRightExpander().module;
+                bool chained = rightModule && rightModule->model == modelXezbeth4XExpander;
+                const XezbethBus::ToMixer* chain = nullptr;
+                if (chained) {
+                        chain = static_cast<const XezbethBus::ToMixer*>(rightExpander.consumerMessage);
+                        if (chain->magic != XezbethBus::MAGIC || chain->version != XezbethBus::VERSION)
+                                chain = nullptr;
                 }
 
-                bool anyPFL = false;
-                double pflL = 0.0;
-                double pflR = 0.0;
-
-                double sumL = 0.0;
-                double sumR = 0.0;
-
+                // Channel strips, one channel per lane
+                float trimDb[4];
+                float pan[4];
+                float_4 inL = 0.f;
+                float_4 inR = 0.f;
+                float_4 mute = 0.f;
+                float_4 solo = 0.f;
+                float_4 pfl = 0.f;
                 for (int i = 0; i < 4; ++i) {
-                        float trim = params[CHANNEL_TRIM_PARAM + i].getValue();
-                        float trimGain = dbToGain(trim);
-                        float pan = params[CHANNEL_PAN_PARAM + i].getValue();
-                        bool mute = params[CHANNEL_MUTE_PARAM + i].getValue() > 0.5f;
-                        bool solo = soloStates[i];
-                        bool pfl = params[CHANNEL_PFL_PARAM + i].getValue() > 0.5f;
-
-                        float inL = 0.f;
-                        float inR = 0.f;
+                        trimDb[i] = params[CHANNEL_TRIM_PARAM + i].getValue();
+                        pan[i] = params[CHANNEL_PAN_PARAM + i].getValue();
+                        mute[i] = params[CHANNEL_MUTE_PARAM + i].getValue();
+                        solo[i] = params[CHANNEL_SOLO_PARAM + i].getValue();
+                        pfl[i] = params[CHANNEL_PFL_PARAM + i].getValue();
                         if (inputs[CHANNEL_INPUT_L + i].isConnected())
-                                inL = inputs[CHANNEL_INPUT_L + i].getVoltage();
+                                inL[i] = inputs[CHANNEL_INPUT_L + i].getVoltage();
                         if (inputs[CHANNEL_INPUT_R + i].isConnected())
-                                inR = inputs[CHANNEL_INPUT_R + i].getVoltage();
+                                inR[i] = inputs[CHANNEL_INPUT_R + i].getVoltage();
                         else
-                                inR = inL;
-
-                        float preL = inL * trimGain;
-                        float preR = inR * trimGain;
-
-                        if (pfl) {
-                                pflL += preL;
-                                pflR += preR;
-                                anyPFL = true;
-                        }
-
-                        bool active = !mute;
-                        if (anySolo)
-                                active = solo;
-
-                        float postL = 0.f;
-                        float postR = 0.f;
-                        if (active) {
-                                auto panOut = applyPan(preL, preR, pan, centerGain);
-                                postL = panOut.first;
-                                postR = panOut.second;
-                                sumL += postL;
-                                sumR += postR;
-                        }
+                                inR[i] = inL[i];
+                }
+                strips.update(trimDb, pan, getPanCenterDb());
+
+                float_4 soloMask = solo > 0.5f;
+                float_4 pflMask = pfl > 0.5f;
+
+                // Solo is global across the chain
+                bool anySolo = _mm_movemask_ps(soloMask.v) != 0 || (chain && chain->soloMask != 0);
+                bool anyPFL = _mm_movemask_ps(pflMask.v) != 0 || (chain && chain->pflMask != 0);
+                float_4 activeMask = anySolo ? soloMask : float_4(mute <= 0.5f);
+
+                float_4 postL;
+                float_4 postR;
+                strips.process(inL, inR, postL, postR);
+                postL = rack::simd::ifelse(activeMask, postL, 0.f);
+                postR = rack::simd::ifelse(activeMask, postR, 0.f);
+
+                // Own strips wait for the expanders' sums to come down the chain
+                int chainLength = chain ? chain->channels / XezbethBus::CHANNELS_PER_EXPANDER : 0;
+                XezbethBus::Sums own;
+                own.sumL = dspext::sumLanes(postL);
+                own.sumR = dspext::sumLanes(postR);
+                own.pflL = dspext::sumLanes(rack::simd::ifelse(pflMask, inL * strips.trimGain, 0.f));
+                own.pflR = dspext::sumLanes(rack::simd::ifelse(pflMask, inR * strips.trimGain, 0.f));
+                own = ownDelay.process(own, XezbethBus::stageDelay(chainLength, -1));
+
+                float sumL = own.sumL;
+                float sumR = own.sumR;
+                float pflL = own.pflL;
+                float pflR = own.pflR;
+                if (chain) {
+                        sumL += anySolo ? chain->soloL : chain->sumL;
+                        sumR += anySolo ? chain->soloR : chain->sumR;
+                        pflL += chain->pflL;
+                        pflR += chain->pflR;
+                }
 
-                        updateMeter(channelMeters[i], postL, postR, sampleTime);
-                        bool postActive = active && (std::fabs(postL) > 1e-4f || std::fabs(postR) > 1e-4f);
-                        lights[CHANNEL_POST_LIGHT + i].setBrightness(postActive ? 1.f : 0.f);
-                        lights[CHANNEL_CLIP_LIGHT + i].setBrightness(channelMeters[i].clipTimer > 0.f ? 1.f : 0.f);
+                if (chained) {
+                        auto* status = static_cast<XezbethBus::ToExpander*>(rightModule->leftExpander.producerMessage);
+                        status->magic = XezbethBus::MAGIC;
+                        status->version = XezbethBus::VERSION;
+                        status->position = 0;
+                        status->panLaw = panLawSetting;
+                        status->anySolo = anySolo;
+                        status->chainLength = chainLength;
+                        rightModule->leftExpander.requestMessageFlip();
                 }
 
-                auto toned = std::pair<float, float>(static_cast<float>(sumL), static_cast<float>(sumR));
+                float meterL[dspext::LoudnessMeterBank::POINTS];
+                float meterR[dspext::LoudnessMeterBank::POINTS];
+                float_4 audible = (rack::simd::fabs(postL) > 1e-4f) | (rack::simd::fabs(postR) > 1e-4f);
+                int postActive = _mm_movemask_ps((activeMask & audible).v);
+                for (int i = 0; i < 4; ++i) {
+                        meterL[i] = postL[i];
+                        meterR[i] = postR[i];
+                        lights[CHANNEL_POST_LIGHT + i].setBrightness((postActive >> i) & 1 ? 1.f : 0.f);
+                }
+                auto toned = std::pair<float, float>(sumL, sumR);
                 if (summingStyle == SUMMING_NEVE) {
                         toned = applyTone(toned.first, toned.second);
                 }
@@ -456,24 +473,23 @@ struct Xezbeth4X : rack::engine::Module {
                                 break;
                 }
 
-                float evenWeight = 0.5f;
-                float oddWeight = 0.5f;
-                float evenBias = 0.18f;
+                DriveShaper shaper;
+                shaper.drive = driveAmount;
                 switch (overtoneFocus) {
                         case OVERTONE_EVEN:
-                                evenWeight = 0.65f;
-                                oddWeight = 0.35f;
-                                evenBias = 0.24f;
+                                shaper.evenWeight = 0.65f;
+                                shaper.oddWeight = 0.35f;
+                                shaper.evenBias = 0.24f;
                                 break;
                         case OVERTONE_BALANCED:
-                                evenWeight = 0.5f;
-                                oddWeight = 0.5f;
-                                evenBias = 0.18f;
+                                shaper.evenWeight = 0.5f;
+                                shaper.oddWeight = 0.5f;
+                                shaper.evenBias = 0.18f;
                                 break;
                         case OVERTONE_ODD:
-                                evenWeight = 0.35f;
-                                oddWeight = 0.65f;
-                                evenBias = 0.12f;
+                                shaper.evenWeight = 0.35f;
+                                shaper.oddWeight = 0.65f;
+                                shaper.evenBias = 0.12f;
                                 break;
                 }
 
@@ -481,13 +497,12 @@ struct Xezbeth4X : rack::engine::Module {
                 float busR = toned.second;
 
                 if (summingStyle == SUMMING_NEVE && driveAmount > 0.f) {
-                        busL = processDriveSample(busL, drivePrevL, driveEnvL, oversample, driveAmount, evenWeight, oddWeight, evenBias, headroom);
-                        busR = processDriveSample(busR, drivePrevR, driveEnvR, oversample, driveAmount, evenWeight, oddWeight, evenBias, headroom);
+                        float_4 driven = processDrive(float_4(busL, busR, 0.f, 0.f), oversample, shaper, headroom);
+                        busL = driven[0];
+                        busR = driven[1];
                 } else {
-                        drivePrevL = static_cast<double>(busL) / headroom;
-                        drivePrevR = static_cast<double>(busR) / headroom;
-                        driveEnvL *= 0.999f;
-                        driveEnvR *= 0.999f;
+                        driveEnv *= 0.999f;
+                        driveRunning = false;
                 }
 
                 if (summingStyle == SUMMING_NEVE) {
@@ -503,9 +518,13 @@ struct Xezbeth4X : rack::engine::Module {
                         busR = limiter(busR);
                 }
 
-                float masterTrim = dbToGain(params[MASTER_TRIM_PARAM].getValue());
-                busL *= masterTrim;
-                busR *= masterTrim;
+                float masterDb = params[MASTER_TRIM_PARAM].getValue();
+                if (masterDb != masterTrimDb) {
+                        masterTrimDb = masterDb;
+                        masterTrimGain = dbToGain(masterDb);
+                }
+                busL *= masterTrimGain;
+                busR *= masterTrimGain;
 
                 float postRecordL = busL;
                 float postRecordR = busR;
@@ -520,7 +539,7 @@ struct Xezbeth4X : rack::engine::Module {
                 }
 
                 if (dim) {
-                        float dimGain = std::pow(10.f, -20.f / 20.f);
+                        const float dimGain = 0.1f; // -20 dB
                         busL *= dimGain;
                         busR *= dimGain;
                 }
@@ -539,14 +558,20 @@ struct Xezbeth4X : rack::engine::Module {
                         busR = softClip(busR);
                 }
 
-                updateMeter(masterMeter, busL, busR, sampleTime);
-                lights[MASTER_CLIP_LIGHT].setBrightness(masterMeter.clipTimer > 0.f ? 1.f : 0.f);
+                meterL[METER_MASTER] = busL;
+                meterR[METER_MASTER] = busR;
 
                 bool routePFLToMaster = anyPFL && !outputs[PFL_OUTPUT_L].isConnected() && !outputs[PFL_OUTPUT_R].isConnected();
 
                 float pflOutL = static_cast<float>(pflL);
                 float pflOutR = static_cast<float>(pflR);
-                updateMeter(pflMeter, pflOutL, pflOutR, sampleTime);
+                meterL[METER_PFL] = pflOutL;
+                meterR[METER_PFL] = pflOutR;
+                meters.peakHold = meterPeakHold;
+                meters.push(meterL, meterR);
+                for (int i = 0; i < 4; ++i)
+                        lights[CHANNEL_CLIP_LIGHT + i].setBrightness(meters.reading(i).clip.load(std::memory_order_relaxed) ? 1.f : 0.f);
+                lights[MASTER_CLIP_LIGHT].setBrightness(meters.reading(METER_MASTER).clip.load(std::memory_order_relaxed) ? 1.f : 0.f);
                 lights[PFL_ACTIVE_LIGHT].setBrightness(anyPFL ? 1.f : 0.f);
 
                 if (anyPFL && routePFLToMaster) {
@@ -572,7 +597,7 @@ struct Xezbeth4X : rack::engine::Module {
                 json_object_set_new(root, "oversamplingQuality", json_integer(oversamplingQuality));
                 json_object_set_new(root, "panLaw", json_integer(panLawSetting));
                 json_object_set_new(root, "meterPeakHold", json_boolean(meterPeakHold));
-                json_object_set_new(root, "meterResponse", json_integer(meterResponse));
+                json_object_set_new(root, "meterLoudness", json_integer(meterResponse));
                 json_object_set_new(root, "headroomMode", json_integer(headroomMode));
                 json_object_set_new(root, "clipSafeEnabled", json_boolean(clipSafeEnabled));
                 return root;
@@ -593,7 +618,8 @@ struct Xezbeth4X : rack::engine::Module {
                         panLawSetting = rack::math::clamp((int)json_integer_value(v), 0, 2);
                 if (json_t* v = json_object_get(root, "meterPeakHold"))
                         meterPeakHold = json_boolean_value(v);
-                if (json_t* v = json_object_get(root, "meterResponse"))
+                // "meterResponse" held the old Fast/Medium/Slow ballistics and is ignored
+                if (json_t* v = json_object_get(root, "meterLoudness"))
                         meterResponse = rack::math::clamp((int)json_integer_value(v), 0, 2);
                 if (json_t* v = json_object_get(root, "headroomMode"))
                         headroomMode = rack::math::clamp((int)json_integer_value(v), 0, 1);
@@ -623,24 +649,33 @@ struct StereoMeterWidget : rack::widget::Widget {
                 nvgFillColor(args.vg, nvgRGB(24, 24, 26));
                 nvgFill(args.vg);
 
-                const MeterState* meter = nullptr;
-                MeterState dummy;
-                if (module) {
-                        if (channel >= 0 && channel < 4)
-                                meter = &module->channelMeters[channel];
-                        else if (channel == 4)
-                                meter = &module->masterMeter;
-                        else if (channel == 5)
-                                meter = &module->pflMeter;
+                float loudness = dspext::LoudnessMeterBank::SILENCE_LUFS;
+                float peak = 0.f;
+                float hold = 0.f;
+                bool clip = false;
+                if (module && channel >= 0 && channel < dspext::LoudnessMeterBank::POINTS) {
+                        const auto& reading = module->meters.reading(channel);
+                        switch (module->meterResponse) {
+                                default:
+                                case Xezbeth4X::RESPONSE_MOMENTARY:
+                                        loudness = reading.momentary.load(std::memory_order_relaxed);
+                                        break;
+                                case Xezbeth4X::RESPONSE_SHORT_TERM:
+                                        loudness = reading.shortTerm.load(std::memory_order_relaxed);
+                                        break;
+                                case Xezbeth4X::RESPONSE_INTEGRATED:
+                                        loudness = reading.integrated.load(std::memory_order_relaxed);
+                                        break;
+                        }
+                        peak = reading.truePeak.load(std::memory_order_relaxed);
+                        hold = reading.peakHold.load(std::memory_order_relaxed);
+                        clip = reading.clip.load(std::memory_order_relaxed);
                 }
-                if (!meter)
-                        meter = &dummy;
 
-                float rmsDb = amplitudeToDb(meter->rms);
-                float peakDb = amplitudeToDb(meter->truePeak);
-                float holdDb = amplitudeToDb(meter->peakHold);
+                float peakDb = amplitudeToDb(peak);
+                float holdDb = amplitudeToDb(hold);
 
-                float rmsNorm = meterNorm(rmsDb);
+                float loudnessNorm = meterNorm(loudness);
                 float peakNorm = meterNorm(peakDb);
                 float holdNorm = meterNorm(holdDb);
 
@@ -649,9 +684,9 @@ struct StereoMeterWidget : rack::widget::Widget {
                 float baseX = 3.f;
                 float baseY = box.size.y - 3.f;
 
-                float rmsHeight = height * rmsNorm;
+                float barHeight = height * loudnessNorm;
                 nvgBeginPath(args.vg);
-                nvgRect(args.vg, baseX, baseY - rmsHeight, width, rmsHeight);
+                nvgRect(args.vg, baseX, baseY - barHeight, width, barHeight);
                 nvgFillColor(args.vg, nvgRGB(64, 180, 92));
                 nvgFill(args.vg);
 
@@ -673,7 +708,7 @@ struct StereoMeterWidget : rack::widget::Widget {
                         nvgStroke(args.vg);
                 }
 
-                if (meter->clipTimer > 0.f) {
+                if (clip) {
                         nvgBeginPath(args.vg);
                         nvgRoundedRect(args.vg, baseX, 3.f, width, 6.f, 2.f);
                         nvgFillColor(args.vg, nvgRGB(220, 32, 32));
@@ -846,7 +881,7 @@ struct Xezbeth4XWidget : rack::app::ModuleWidget {
                 menu->addChild(createIndexPtrSubmenuItem("Overtone Focus", {"Even-lean", "Balanced", "Odd-lean"}, &module->overtoneFocus));
                 menu->addChild(createIndexPtrSubmenuItem("Oversampling", {"1×", "2×", "4×", "8×"}, &module->oversamplingQuality));
                 menu->addChild(createIndexPtrSubmenuItem("Pan Law", {"−3 dB", "−4.5 dB", "−6 dB"}, &module->panLawSetting));
-                menu->addChild(createIndexPtrSubmenuItem("Meter Ballistics", {"Fast", "Medium", "Slow"}, &module->meterResponse));
+                menu->addChild(createIndexPtrSubmenuItem("Meter Loudness", {"Momentary (400 ms)", "Short-term (3 s)", "Integrated"}, &module->meterResponse));
                 menu->addChild(createIndexPtrSubmenuItem("Headroom Model", {"Standard (+24 dB)", "Extended (+30 dB)"}, &module->headroomMode));
 
                 menu->addChild(createCheckMenuItem("Meter peak hold", "", [module]() { return module->meterPeakHold; }, [module]() {
@@ -856,6 +891,22 @@ struct Xezbeth4XWidget : rack::app::ModuleWidget {
                 menu->addChild(createCheckMenuItem("Clip-Safe on master", "", [module]() { return module->clipSafeEnabled; }, [module]() {
                         module->clipSafeEnabled = !module->clipSafeEnabled;
                 }));
+
+                // BS.1770 readings, relative to the 1 V full scale of the clip lights
+                menu->addChild(new rack::ui::MenuSeparator());
+                auto addReading = [menu, module](const char* name, int point) {
+                        const auto& reading = module->meters.reading(point);
+                        char text[128];
+                        std::snprintf(text, sizeof(text), "%s: M %.1f  S %.1f  I %.1f LUFS, TP max %.1f dBTP", name,
+                                      reading.momentary.load(), reading.shortTerm.load(), reading.integrated.load(),
+                                      amplitudeToDb(reading.maxTruePeak.load()));
+                        menu->addChild(createMenuLabel(text));
+                };
+                addReading("Master", Xezbeth4X::METER_MASTER);
+                addReading("PFL", Xezbeth4X::METER_PFL);
+                menu->addChild(createMenuItem("Reset integrated loudness", "", [module]() {
+                        module->meters.requestReset();
+                }));
         }
 };
 
@@ -0,0 +1,336 @@
+#include "plugin.hpp"
+#include "XezbethBus.hpp"
+#include "dsp/ChannelStrip.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+namespace {
+
+using namespace rack::componentlibrary;
+using rack::createInputCentered;
+using rack::createLightCentered;
+using rack::createParamCentered;
+using rack::createWidget;
+using rack::simd::float_4;
+
+static inline bool isMixerModule(rack::engine::Module* module) {
+        return module && (module->model == modelXezbeth4X || module->model == modelXezbeth4XExpander);
+}
+
+// Center gains of the mixer's pan laws, in Xezbeth4X::PanLaw order
+static const float PAN_CENTER_DB[] = {-3.f, -4.5f, -6.f};
+
+// Four more channel strips for Xezbeth:4X. Place it to the right of the
+// mixer or of another expander. The channels are summed here, four at a
+// time as float_4 lanes, so the mixer only adds one stereo pair per chain.
+struct Xezbeth4XExpander : rack::engine::Module {
+        enum ParamIds {
+                CHANNEL_TRIM_PARAM,
+                CHANNEL_TRIM_PARAM_LAST = CHANNEL_TRIM_PARAM + 3,
+                CHANNEL_PAN_PARAM,
+                CHANNEL_PAN_PARAM_LAST = CHANNEL_PAN_PARAM + 3,
+                CHANNEL_MUTE_PARAM,
+                CHANNEL_MUTE_PARAM_LAST = CHANNEL_MUTE_PARAM + 3,
+                CHANNEL_SOLO_PARAM,
+                CHANNEL_SOLO_PARAM_LAST = CHANNEL_SOLO_PARAM + 3,
+                CHANNEL_PFL_PARAM,
+                CHANNEL_PFL_PARAM_LAST = CHANNEL_PFL_PARAM + 3,
+                NUM_PARAMS
+        };
+
+        enum InputIds {
+                CHANNEL_INPUT_L,
+                CHANNEL_INPUT_L_LAST = CHANNEL_INPUT_L + 3,
+                CHANNEL_INPUT_R,
+                CHANNEL_INPUT_R_LAST = CHANNEL_INPUT_R + 3,
+                NUM_INPUTS
+        };
+
+        enum OutputIds {
+                NUM_OUTPUTS
+        };
+
+        enum LightIds {
+                CHANNEL_POST_LIGHT,
+                CHANNEL_POST_LIGHT_LAST = CHANNEL_POST_LIGHT + 3,
+                LINK_LIGHT,
+                NUM_LIGHTS
+        };
+
+        // Sums from the expander on the right, and status from the left
+        XezbethBus::ToMixer chainMessages[2]{};
+        XezbethBus::ToExpander statusMessages[2]{};
+
+        // Trim and pan gains of the four strips
+        dspext::ChannelStrip4 strips;
+
+        // First chained channel, for the context menu; -1 while unlinked
+        int position = -1;
+
+        // Own sums held back so every strip of the chain lands on the bus together
+        XezbethBus::SumDelay sumDelay;
+        rack::engine::Module* lastLeftModule = nullptr;
+
+        Xezbeth4XExpander() {
+                config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
+
+                for (int i = 0; i < 4; ++i) {
+                        configParam(CHANNEL_TRIM_PARAM + i, -60.f, 12.f, 0.f, "Channel " + std::to_string(i + 1) + " trim", " dB");
+                        configParam(CHANNEL_PAN_PARAM + i, -1.f, 1.f, 0.f, "Channel " + std::to_string(i + 1) + " pan");
+                        configButton(CHANNEL_MUTE_PARAM + i, "Channel " + std::to_string(i + 1) + " mute");
+                        configButton(CHANNEL_SOLO_PARAM + i, "Channel " + std::to_string(i + 1) + " solo");
+                        configButton(CHANNEL_PFL_PARAM + i, "Channel " + std::to_string(i + 1) + " PFL");
+
+                        configInput(CHANNEL_INPUT_L + i, "Channel " + std::to_string(i + 1) + " left");
+                        configInput(CHANNEL_INPUT_R + i, "Channel " + std::to_string(i + 1) + " right");
+                }
+
+                rightExpander.producerMessage = &chainMessages[0];
+                rightExpander.consumerMessage = &chainMessages[1];
+                leftExpander.producerMessage = &statusMessages[0];
+                leftExpander.consumerMessage = &statusMessages[1];
+        }
+
+        void process(const ProcessArgs& args) override {
+                rack::engine::Module* leftModule = getLeftExpander().module;
+                rack::engine::Module* rightModule = getRightExpander().module;
+                bool rightChained = rightModule && rightModule->model == modelXezbeth4XExpander;
+
+                // Status from a previous left neighbour no longer applies
+                auto* status = static_cast<XezbethBus::ToExpander*>(leftExpander.consumerMessage);
+                if (leftModule != lastLeftModule) {
+                        status->magic = 0;
+                        lastLeftModule = leftModule;
+                }
+
+                // Linked once a mixer's status has come down the chain
+                bool statusValid = status->magic == XezbethBus::MAGIC && status->version == XezbethBus::VERSION;
+                if (!isMixerModule(leftModule) || !statusValid) {
+                        position = -1;
+                        for (int i = 0; i < 4; ++i)
+                                lights[CHANNEL_POST_LIGHT + i].setBrightness(0.f);
+                        lights[LINK_LIGHT].setBrightness(0.f);
+                        // Tell the rest of the chain it is unlinked too
+                        if (rightChained) {
+                                auto* next = static_cast<XezbethBus::ToExpander*>(rightModule->leftExpander.producerMessage);
+                                next->magic = 0;
+                                rightModule->leftExpander.requestMessageFlip();
+                        }
+                        return;
+                }
+
+                int channelBase = status->position * XezbethBus::CHANNELS_PER_EXPANDER;
+                int panLaw = std::min<int>(status->panLaw, 2);
+                bool mixerSolo = status->anySolo;
+                position = channelBase;
+
+                float trimDb[4];
+                float pan[4];
+                float_4 inL = 0.f;
+                float_4 inR = 0.f;
+                float_4 mute = 0.f;
+                float_4 solo = 0.f;
+                float_4 pfl = 0.f;
+                for (int i = 0; i < 4; ++i) {
+                        trimDb[i] = params[CHANNEL_TRIM_PARAM + i].getValue();
+                        pan[i] = params[CHANNEL_PAN_PARAM + i].getValue();
+                        if (inputs[CHANNEL_INPUT_L + i].isConnected())
+                                inL[i] = inputs[CHANNEL_INPUT_L + i].getVoltage();
+                        if (inputs[CHANNEL_INPUT_R + i].isConnected())
+                                inR[i] = inputs[CHANNEL_INPUT_R + i].getVoltage();
+                        else
+                                inR[i] = inL[i];
+                        mute[i] = params[CHANNEL_MUTE_PARAM + i].getValue();
+                        solo[i] = params[CHANNEL_SOLO_PARAM + i].getValue();
+                        pfl[i] = params[CHANNEL_PFL_PARAM + i].getValue();
+                }
+                strips.update(trimDb, pan, PAN_CENTER_DB[panLaw]);
+
+                float_4 unmutedMask = mute <= 0.5f;
+                float_4 soloMask = solo > 0.5f;
+                float_4 pflMask = pfl > 0.5f;
+
+                float_4 postL;
+                float_4 postR;
+                strips.process(inL, inR, postL, postR);
+
+                uint64_t soloBits = 0;
+                uint64_t pflBits = 0;
+                for (int i = 0; i < 4; ++i) {
+                        if (solo[i] > 0.5f)
+                                soloBits |= 1u << i;
+                        if (pfl[i] > 0.5f)
+                                pflBits |= 1u << i;
+                }
+                if (channelBase < XezbethBus::MAX_CHAIN_CHANNELS) {
+                        soloBits <<= channelBase;
+                        pflBits <<= channelBase;
+                } else {
+                        soloBits = pflBits = 0;
+                }
+
+                // Everything chained beyond this expander
+                const XezbethBus::ToMixer* chain = nullptr;
+                if (rightChained) {
+                        chain = static_cast<const XezbethBus::ToMixer*>(rightExpander.consumerMessage);
+                        if (chain->magic != XezbethBus::MAGIC || chain->version != XezbethBus::VERSION)
+                                chain = nullptr;
+                }
+
+                XezbethBus::Sums own;
+                own.sumL = dspext::sumLanes(rack::simd::ifelse(unmutedMask, postL, 0.f));
+                own.sumR = dspext::sumLanes(rack::simd::ifelse(unmutedMask, postR, 0.f));
+                own.soloL = dspext::sumLanes(rack::simd::ifelse(soloMask, postL, 0.f));
+                own.soloR = dspext::sumLanes(rack::simd::ifelse(soloMask, postR, 0.f));
+                own.pflL = dspext::sumLanes(rack::simd::ifelse(pflMask, inL * strips.trimGain, 0.f));
+                own.pflR = dspext::sumLanes(rack::simd::ifelse(pflMask, inR * strips.trimGain, 0.f));
+                own = sumDelay.process(own, XezbethBus::stageDelay(status->chainLength, status->position));
+
+                auto* out = static_cast<XezbethBus::ToMixer*>(leftModule->rightExpander.producerMessage);
+                out->magic = XezbethBus::MAGIC;
+                out->version = XezbethBus::VERSION;
+                out->sumL = own.sumL;
+                out->sumR = own.sumR;
+                out->soloL = own.soloL;
+                out->soloR = own.soloR;
+                out->pflL = own.pflL;
+                out->pflR = own.pflR;
+                out->soloMask = soloBits;
+                out->pflMask = pflBits;
+                out->channels = XezbethBus::CHANNELS_PER_EXPANDER;
+                if (chain) {
+                        out->sumL += chain->sumL;
+                        out->sumR += chain->sumR;
+                        out->soloL += chain->soloL;
+                        out->soloR += chain->soloR;
+                        out->pflL += chain->pflL;
+                        out->pflR += chain->pflR;
+                        out->soloMask |= chain->soloMask;
+                        out->pflMask |= chain->pflMask;
+                        out->channels = std::min(chain->channels + XezbethBus::CHANNELS_PER_EXPANDER, 255);
+                }
+                leftModule->rightExpander.requestMessageFlip();
+
+                if (rightChained) {
+                        auto* next = static_cast<XezbethBus::ToExpander*>(rightModule->leftExpander.producerMessage);
+                        next->magic = XezbethBus::MAGIC;
+                        next->version = XezbethBus::VERSION;
+                        next->position = std::min(status->position + 1, 255);
+                        next->panLaw = panLaw;
+                        next->anySolo = mixerSolo;
+                        next->chainLength = status->chainLength;
+                        rightModule->leftExpander.requestMessageFlip();
+                }
+
+                for (int i = 0; i < 4; ++i) {
+                        bool active = mixerSolo ? solo[i] > 0.5f : mute[i] <= 0.5f;
+                        bool postActive = active && (std::fabs(postL[i]) > 1e-4f || std::fabs(postR[i]) > 1e-4f);
+                        lights[CHANNEL_POST_LIGHT + i].setBrightness(postActive ? 1.f : 0.f);
+                }
+                lights[LINK_LIGHT].setBrightness(1.f);
+        }
+};
+
+struct BackgroundImage : Widget {
+	std::string imagePath = asset::plugin(pluginInstance, "res/TextureDemonMainV2.png");
+	widget::SvgWidget* svgWidget;
+
+	BackgroundImage() {
+		// Create & load SVG child safely
+		svgWidget = new widget::SvgWidget();
+		addChild(svgWidget);
+		try {
+			auto svg = APP->window->loadSvg(asset::plugin(pluginInstance, "res/Xezbeth4XExpander.svg"));
+			if (svg) {
+				svgWidget->setSvg(svg);
+			} else {
+				WARN("SVG returned null: res/Xezbeth4XExpander.svg");
+			}
+		} catch (const std::exception& e) {
+			WARN("Exception loading SVG res/Xezbeth4XExpander.svg: %s", e.what());
+			// Leave svgWidget with no SVG; still safe to run.
+		}
+        }
+
+	void draw(const DrawArgs& args) override {
+		// Draw background image first
+                std::shared_ptr<Image> image = APP->window->loadImage(imagePath);
+                if (image && box.size.x > 0.f && box.size.y > 0.f) {
+			int w = box.size.x;
+			int h = box.size.y;
+
+			NVGpaint paint = nvgImagePattern(args.vg, 0, 0, w, h, 0.0f, image->handle, 1.0f);
+			nvgBeginPath(args.vg);
+			nvgRect(args.vg, 0, 0, w, h);
+			nvgFillPaint(args.vg, paint);
+			nvgFill(args.vg);
+		}
+		// SVG will be drawn automatically by the child SvgWidget
+		Widget::draw(args);
+	}
+};
+
+struct Xezbeth4XExpanderWidget : rack::app::ModuleWidget {
+        explicit Xezbeth4XExpanderWidget(Xezbeth4XExpander* module) {
+                setModule(module);
+                setPanel(createPanel(asset::plugin(pluginInstance, "res/Xezbeth4XExpander.svg")));
+
+                auto bg = new BackgroundImage();
+		bg->box.pos = Vec(0, 0);
+		bg->box.size = box.size;
+		addChild(bg);
+
+                addChild(createWidget<ScrewBlack>(rack::Vec(rack::RACK_GRID_WIDTH, 0)));
+                addChild(createWidget<ScrewBlack>(rack::Vec(box.size.x - 2 * rack::RACK_GRID_WIDTH, 0)));
+                addChild(createWidget<ScrewBlack>(rack::Vec(rack::RACK_GRID_WIDTH, rack::RACK_GRID_HEIGHT - rack::RACK_GRID_WIDTH)));
+                addChild(createWidget<ScrewBlack>(rack::Vec(box.size.x - 2 * rack::RACK_GRID_WIDTH, rack::RACK_GRID_HEIGHT - rack::RACK_GRID_WIDTH)));
+
+                // Same strip layout as the mixer
+                const float chSpacing = 11.5f;
+                const float chStart = 5.6f;
+                const float inputY = 18.f;
+                const float knobY = 34.f;
+                const float btnY = 48.f;
+                const float btnSpacing = 5.5f;
+
+                for (int i = 0; i < 4; ++i) {
+                        float x = chStart + chSpacing * i;
+
+                        addInput(createInputCentered<PJ301MPort>(rack::mm2px(rack::Vec(x, inputY)), module, Xezbeth4XExpander::CHANNEL_INPUT_L + i));
+                        addInput(createInputCentered<PJ301MPort>(rack::mm2px(rack::Vec(x, inputY + 8)), module, Xezbeth4XExpander::CHANNEL_INPUT_R + i));
+
+                        addParam(createParamCentered<Trimpot>(rack::mm2px(rack::Vec(x, knobY)), module, Xezbeth4XExpander::CHANNEL_TRIM_PARAM + i));
+                        addParam(createParamCentered<Trimpot>(rack::mm2px(rack::Vec(x, knobY + 8.f)), module, Xezbeth4XExpander::CHANNEL_PAN_PARAM + i));
+
+                        addParam(createParamCentered<TL1105>(rack::mm2px(rack::Vec(x, btnY)), module, Xezbeth4XExpander::CHANNEL_MUTE_PARAM + i));
+                        addChild(createLightCentered<TinyLight<GreenLight>>(rack::mm2px(rack::Vec(x - 3.5f, btnY)), module, Xezbeth4XExpander::CHANNEL_POST_LIGHT + i));
+                        addParam(createParamCentered<TL1105>(rack::mm2px(rack::Vec(x, btnY + btnSpacing)), module, Xezbeth4XExpander::CHANNEL_SOLO_PARAM + i));
+                        addParam(createParamCentered<TL1105>(rack::mm2px(rack::Vec(x, btnY + 2 * btnSpacing)), module, Xezbeth4XExpander::CHANNEL_PFL_PARAM + i));
+                }
+
+                addChild(createLightCentered<SmallLight<YellowLight>>(rack::mm2px(rack::Vec(22.86f, 10.f)), module, Xezbeth4XExpander::LINK_LIGHT));
+        }
+
+        void appendContextMenu(rack::ui::Menu* menu) override {
+                ModuleWidget::appendContextMenu(menu);
+                auto* module = dynamic_cast<Xezbeth4XExpander*>(this->module);
+                if (!module)
+                        return;
+
+                menu->addChild(new rack::ui::MenuSeparator());
+                int first = module->position;
+                if (first < 0) {
+                        menu->addChild(createMenuLabel("Not linked: place to the right of Xezbeth:4X"));
+                } else {
+                        char text[64];
+                        std::snprintf(text, sizeof(text), "Mixer channels %d-%d", first + 5, first + 8);
+                        menu->addChild(createMenuLabel(text));
+                }
+        }
+};
+
+} // namespace
+
+Model* modelXezbeth4XExpander = createModel<Xezbeth4XExpander, Xezbeth4XExpanderWidget>("Xezbeth4XExpander");
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+
+// Messages between Xezbeth:4X and its channel expanders. Expanders chain to
+// the right of the mixer; each one adds its channels to the sums coming
+// from its right neighbour and hands the result to its left neighbour, so
+// the mixer receives one pre-summed stereo pair for the whole chain.
+//
+// Rack delivers expander messages one engine step after they are written,
+// so every hop costs a sample. With n expanders chained, the one at
+// position k holds its own sums back n - 1 - k samples and the mixer holds
+// its own strips back n samples: every strip then reaches the bus on the
+// same sample, and the bus runs a fixed n samples behind the inputs.
+namespace XezbethBus {
+
+static const int32_t MAGIC = 0x58455A42; // 'XEZB'
+static const uint8_t VERSION = 2;
+
+static const int CHANNELS_PER_EXPANDER = 4;
+static const int MAX_CHAIN_CHANNELS = 64;
+
+// Expander -> left neighbour, written into the neighbour's rightExpander
+struct ToMixer {
+        int32_t magic = MAGIC;
+        uint8_t version = VERSION;
+        uint8_t channels = 0;        // chained channels summed into this message
+        uint8_t reserved[2] = {};
+        // Post-fader sums of every unmuted channel, used while nothing is soloed
+        float sumL = 0.f;
+        float sumR = 0.f;
+        // Post-fader sums of the soloed channels only
+        float soloL = 0.f;
+        float soloR = 0.f;
+        // Pre-fader sums of the PFL channels
+        float pflL = 0.f;
+        float pflR = 0.f;
+        // Bit n is the nth chained channel, counted from the mixer outwards
+        uint64_t soloMask = 0;
+        uint64_t pflMask = 0;
+};
+
+// Left neighbour -> expander, written into the expander's leftExpander
+struct ToExpander {
+        int32_t magic = MAGIC;
+        uint8_t version = VERSION;
+        uint8_t position = 0;        // 0 for the expander next to the mixer
+        uint8_t panLaw = 0;          // Xezbeth4X::PanLaw of the mixer
+        uint8_t anySolo = 0;         // a channel anywhere on the mixer is soloed
+        uint8_t chainLength = 0;     // expanders chained to the mixer
+};
+
+// One stage's contribution to the bus
+struct Sums {
+        float sumL = 0.f;
+        float sumR = 0.f;
+        float soloL = 0.f;
+        float soloR = 0.f;
+        float pflL = 0.f;
+        float pflR = 0.f;
+};
+
+// Holds a stage's sums back by a whole number of samples, see above
+struct SumDelay {
+        // Longest chain the 8-bit channel count can describe
+        static const int MAX_DELAY = 255 / CHANNELS_PER_EXPANDER + 1;
+
+        Sums history[MAX_DELAY + 1];
+        int pos = 0;
+
+        Sums process(const Sums& in, int delay) {
+                delay = delay < 0 ? 0 : (delay > MAX_DELAY ? MAX_DELAY : delay);
+                pos = pos == MAX_DELAY ? 0 : pos + 1;
+                history[pos] = in;
+                int read = pos - delay;
+                return history[read < 0 ? read + MAX_DELAY + 1 : read];
+        }
+};
+
+// Stage delay for the expander at position, or for the mixer with -1
+inline int stageDelay(int chainLength, int position) {
+        int delay = chainLength - 1 - position;
+        return delay > 0 ? delay : 0;
+}
+
+} // namespace XezbethBus
@@ -0,0 +1,89 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <simd/functions.hpp>
+
+namespace dspext {
+
+// sin over a quarter turn, x in [0, 1] maps to [0, pi/2]. Linear
+// interpolation over PAN_TABLE_SIZE segments stays within 2e-6 of sin.
+static constexpr int PAN_TABLE_SIZE = 512;
+
+inline float quarterSine(float x) {
+    struct Table {
+        float values[PAN_TABLE_SIZE + 1];
+        Table() {
+            for (int i = 0; i <= PAN_TABLE_SIZE; ++i)
+                values[i] = std::sin(0.5f * (float)M_PI * i / PAN_TABLE_SIZE);
+        }
+    };
+    static const Table table;
+
+    float pos = std::fmin(std::fmax(x, 0.f), 1.f) * PAN_TABLE_SIZE;
+    int index = std::min((int)pos, PAN_TABLE_SIZE - 1);
+    float frac = pos - index;
+    return table.values[index] + frac * (table.values[index + 1] - table.values[index]);
+}
+
+inline float sumLanes(rack::simd::float_4 v) {
+    return (v[0] + v[1]) + (v[2] + v[3]);
+}
+
+// Trim and constant-power pan of four stereo channels, one per float_4
+// lane. Each input side gets its own pan angle, spread by STEREO_WIDTH
+// around the pan position. The gains are folded into four vectors and only
+// recomputed for channels whose trim, pan or pan law changed.
+class ChannelStrip4 {
+public:
+    static constexpr float STEREO_WIDTH = 0.5f;
+
+    rack::simd::float_4 trimGain = 1.f;
+    rack::simd::float_4 leftToL = 0.f;
+    rack::simd::float_4 leftToR = 0.f;
+    rack::simd::float_4 rightToL = 0.f;
+    rack::simd::float_4 rightToR = 0.f;
+
+    // centerDb is the level of a centered mono signal in each side
+    void update(const float* trimDb, const float* pan, float centerDb) {
+        if (centerDb != lastCenterDb) {
+            lastCenterDb = centerDb;
+            centerScale = std::pow(10.f, centerDb / 20.f) / std::sqrt(0.5f);
+            for (int i = 0; i < 4; ++i)
+                computeChannel(i, trimDb[i], pan[i]);
+            return;
+        }
+        for (int i = 0; i < 4; ++i) {
+            if (trimDb[i] != lastTrimDb[i] || pan[i] != lastPan[i])
+                computeChannel(i, trimDb[i], pan[i]);
+        }
+    }
+
+    void process(rack::simd::float_4 inL, rack::simd::float_4 inR,
+                 rack::simd::float_4& postL, rack::simd::float_4& postR) const {
+        postL = inL * leftToL + inR * rightToL;
+        postR = inL * leftToR + inR * rightToR;
+    }
+
+private:
+    float lastTrimDb[4] = {};
+    float lastPan[4] = {};
+    float lastCenterDb = NAN;
+    float centerScale = 1.f;
+
+    void computeChannel(int i, float trimDb, float pan) {
+        lastTrimDb[i] = trimDb;
+        lastPan[i] = pan;
+
+        float gain = trimDb <= -80.f ? 0.f : std::pow(10.f, trimDb / 20.f);
+        float sideL = 0.5f * (std::fmin(std::fmax(pan - STEREO_WIDTH, -1.f), 1.f) + 1.f);
+        float sideR = 0.5f * (std::fmin(std::fmax(pan + STEREO_WIDTH, -1.f), 1.f) + 1.f);
+        float scale = gain * centerScale;
+        trimGain[i] = gain;
+        leftToL[i] = scale * quarterSine(1.f - sideL);
+        leftToR[i] = scale * quarterSine(sideL);
+        rightToL[i] = scale * quarterSine(1.f - sideR);
+        rightToR[i] = scale * quarterSine(sideR);
+    }
+};
+
+} // namespace dspext
@@ -0,0 +1,289 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <simd/functions.hpp>
+#include "Convolver.hpp"
+#include "Wav.hpp"
+
+namespace dspext {
+
+AlignedFloats::~AlignedFloats() {
+    if (data)
+        pffft_aligned_free(data);
+}
+
+void AlignedFloats::resize(int n) {
+    if (data)
+        pffft_aligned_free(data);
+    data = n > 0 ? (float*)pffft_aligned_malloc(sizeof(float) * n) : nullptr;
+    size = n;
+    zero();
+}
+
+void AlignedFloats::zero() {
+    if (data)
+        std::fill(data, data + size, 0.f);
+}
+
+PartitionedConvolver::~PartitionedConvolver() {
+    if (setup)
+        pffft_destroy_setup(setup);
+}
+
+void PartitionedConvolver::init(const float* ir, int length, int blockSize) {
+    if (setup) {
+        pffft_destroy_setup(setup);
+        setup = nullptr;
+    }
+    block = blockSize;
+    fftSize = 2 * blockSize;
+    numParts = length > 0 ? (length + block - 1) / block : 0;
+    fdlPos = 0;
+    if (numParts == 0)
+        return;
+
+    setup = pffft_new_setup(fftSize, PFFFT_REAL);
+    irSpectra.resize(numParts * fftSize);
+    fdl.resize(numParts * fftSize);
+    window.resize(fftSize);
+    accum.resize(fftSize);
+    work.resize(fftSize);
+
+    // Each partition is zero-padded to the FFT size, so overlap-save keeps
+    // the last block of every circular convolution
+    for (int p = 0; p < numParts; p++) {
+        window.zero();
+        int n = std::min(block, length - p * block);
+        std::copy(ir + p * block, ir + p * block + n, window.data);
+        pffft_transform(setup, window.data, irSpectra + p * fftSize, work.data, PFFFT_FORWARD);
+    }
+    window.zero();
+}
+
+void PartitionedConvolver::reset() {
+    fdl.zero();
+    window.zero();
+    fdlPos = 0;
+}
+
+void PartitionedConvolver::processBlock(const float* in, float* out) {
+    if (numParts == 0) {
+        std::fill(out, out + block, 0.f);
+        return;
+    }
+    std::memmove(window.data, window.data + block, sizeof(float) * block);
+    std::copy(in, in + block, window.data + block);
+    pffft_transform(setup, window.data, fdl + fdlPos * fftSize, work.data, PFFFT_FORWARD);
+
+    // Spectrum of input block n - p times IR partition p, summed in the
+    // frequency domain so only one inverse FFT is needed per block
+    accum.zero();
+    const float scale = 1.f / fftSize;
+    for (int p = 0, idx = fdlPos; p < numParts; p++) {
+        pffft_zconvolve_accumulate(setup, fdl + idx * fftSize, irSpectra + p * fftSize, accum.data, scale);
+        idx = (idx == 0) ? numParts - 1 : idx - 1;
+    }
+    pffft_transform(setup, accum.data, accum.data, work.data, PFFFT_BACKWARD);
+    std::copy(accum.data + block, accum.data + fftSize, out);
+
+    if (++fdlPos == numParts)
+        fdlPos = 0;
+}
+
+ConvolutionEngine::ConvolutionEngine(const std::vector<float>& irL, const std::vector<float>& irR) {
+    initChannel(channels[0], irL);
+    initChannel(channels[1], irR.empty() ? irL : irR);
+    length = (int)std::max(irL.size(), irR.size());
+    hasTail = !channels[0].tail.empty() || !channels[1].tail.empty();
+    if (hasTail)
+        worker = std::thread(&ConvolutionEngine::workerLoop, this);
+}
+
+ConvolutionEngine::~ConvolutionEngine() {
+    {
+        std::lock_guard<std::mutex> lock(workerMutex);
+        quit.store(true, std::memory_order_release);
+    }
+    workerCV.notify_one();
+    if (worker.joinable())
+        worker.join();
+}
+
+void ConvolutionEngine::initChannel(Channel& ch, const std::vector<float>& ir) {
+    int n = (int)ir.size();
+
+    ch.headTaps.assign(HEAD_LENGTH, 0.f);
+    for (int i = 0; i < std::min(n, HEAD_LENGTH); i++)
+        ch.headTaps[HEAD_LENGTH - 1 - i] = ir[i];
+    ch.history.assign(2 * HEAD_LENGTH, 0.f);
+
+    int midLength = std::max(0, std::min(n, TAIL_START) - HEAD_LENGTH);
+    ch.mid.init(ir.data() + HEAD_LENGTH, midLength, HEAD_LENGTH);
+    ch.midIn.assign(HEAD_LENGTH, 0.f);
+    ch.midOut.assign(HEAD_LENGTH, 0.f);
+
+    int tailLength = std::max(0, n - TAIL_START);
+    ch.tail.init(tailLength > 0 ? ir.data() + TAIL_START : nullptr, tailLength, TAIL_BLOCK);
+    ch.tailIn.assign(TAIL_BLOCK, 0.f);
+    ch.jobIn.assign(TAIL_BLOCK, 0.f);
+    ch.jobOut[0].assign(TAIL_BLOCK, 0.f);
+    ch.jobOut[1].assign(TAIL_BLOCK, 0.f);
+}
+
+float ConvolutionEngine::processHead(Channel& ch) {
+    // history[historyPos + 1 .. historyPos + HEAD_LENGTH] is the input window,
+    // oldest first, matching the reversed taps
+    const float* x = ch.history.data() + historyPos + 1;
+    const float* h = ch.headTaps.data();
+    rack::simd::float_4 acc = 0.f;
+    for (int i = 0; i < HEAD_LENGTH; i += 4)
+        acc += rack::simd::float_4::load(x + i) * rack::simd::float_4::load(h + i);
+    return acc[0] + acc[1] + acc[2] + acc[3];
+}
+
+void ConvolutionEngine::process(float inL, float inR, float& earlyL, float& earlyR, float& lateL, float& lateR) {
+    const float in[2] = {inL, inR};
+    float early[2];
+    float late[2];
+
+    historyPos = (historyPos + 1) & (HEAD_LENGTH - 1);
+    int jobs = submitted.load(std::memory_order_relaxed);
+    for (int c = 0; c < 2; c++) {
+        Channel& ch = channels[c];
+        ch.history[historyPos] = in[c];
+        ch.history[historyPos + HEAD_LENGTH] = in[c];
+        early[c] = processHead(ch) + ch.midOut[midPos];
+        ch.midIn[midPos] = in[c];
+
+        late[c] = 0.f;
+        if (hasTail) {
+            // Job n - 2 holds the tail for the current block
+            if (jobs >= 2 && !tailMissed)
+                late[c] = ch.jobOut[jobs % 2][tailPos];
+            ch.tailIn[tailPos] = in[c];
+        }
+    }
+
+    if (++midPos == HEAD_LENGTH) {
+        for (Channel& ch : channels)
+            ch.mid.processBlock(ch.midIn.data(), ch.midOut.data());
+        midPos = 0;
+    }
+    if (hasTail && ++tailPos == TAIL_BLOCK) {
+        submitTail();
+        tailPos = 0;
+    }
+
+    earlyL = early[0];
+    earlyR = early[1];
+    lateL = late[0];
+    lateR = late[1];
+}
+
+void ConvolutionEngine::submitTail() {
+    int jobs = submitted.load(std::memory_order_relaxed);
+    // The previous job is due now. The worker has had a whole block period,
+    // so it is only late when the machine is overloaded. The audio thread
+    // never waits for it: this block's input is dropped and the tail is
+    // silent for the next period, while the worker catches up.
+    if (completed.load(std::memory_order_acquire) < jobs) {
+        tailMissed = true;
+        missedBlocks.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    tailMissed = false;
+    for (Channel& ch : channels)
+        std::swap(ch.tailIn, ch.jobIn);
+    // The worker holds the mutex only while it tests its predicate, so this
+    // is uncontended except for that instant and closes the lost-wakeup race
+    {
+        std::lock_guard<std::mutex> lock(workerMutex);
+        submitted.store(jobs + 1, std::memory_order_release);
+    }
+    workerCV.notify_one();
+}
+
+void ConvolutionEngine::workerLoop() {
+    int done = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(workerMutex);
+            workerCV.wait(lock, [&] {
+                return quit.load(std::memory_order_acquire) || submitted.load(std::memory_order_acquire) > done;
+            });
+            if (quit.load(std::memory_order_acquire))
+                return;
+        }
+        for (Channel& ch : channels)
+            ch.tail.processBlock(ch.jobIn.data(), ch.jobOut[done % 2].data());
+        done++;
+        completed.store(done, std::memory_order_release);
+    }
+}
+
+bool loadImpulseResponse(const std::string& path, float sampleRate, float maxSeconds,
+                         std::vector<float>& irL, std::vector<float>& irR, std::string& error) {
+    // Room for maxSeconds of eight 32-bit channels at 384 kHz, plus headers
+    size_t maxBytes = (size_t)(maxSeconds * 384000.f) * 8 * 4 + (1 << 20);
+    std::vector<uint8_t> bytes;
+    if (!readFileBytes(path, maxBytes, bytes, error))
+        return false;
+    WavInfo info;
+    if (!readWavInfo(bytes, info, error))
+        return false;
+    std::vector<float> raw[2];
+    int frames = (int)std::min((double)info.frames, std::ceil((double)maxSeconds * info.sampleRate));
+    int usedChannels = decodeWav(bytes, info, 2, frames, raw);
+    uint32_t fileRate = info.sampleRate;
+
+    // Linear resampling to the engine rate
+    std::vector<float>* outs[2] = {&irL, &irR};
+    double ratio = fileRate / (double)sampleRate;
+    int outFrames = std::max(1, (int)((frames - 1) / ratio) + 1);
+    for (int c = 0; c < usedChannels; c++) {
+        std::vector<float>& out = *outs[c];
+        out.resize(outFrames);
+        for (int i = 0; i < outFrames; i++) {
+            double t = i * ratio;
+            int i0 = std::min((int)t, frames - 1);
+            int i1 = std::min(i0 + 1, frames - 1);
+            float frac = (float)(t - i0);
+            out[i] = raw[c][i0] + frac * (raw[c][i1] - raw[c][i0]);
+        }
+    }
+    if (usedChannels == 1)
+        irR = irL;
+
+    // Trim the tail below -100 dB of the peak so silence costs nothing
+    float peak = 0.f;
+    for (std::vector<float>* out : outs)
+        for (float v : *out)
+            peak = std::max(peak, std::fabs(v));
+    if (peak <= 0.f) {
+        error = "WAV file is silent";
+        return false;
+    }
+    int end = 1;
+    for (std::vector<float>* out : outs)
+        for (int i = (int)out->size() - 1; i >= end; i--)
+            if (std::fabs((*out)[i]) > peak * 1e-5f) {
+                end = i + 1;
+                break;
+            }
+
+    double energy = 0.0;
+    for (std::vector<float>* out : outs) {
+        out->resize(end);
+        double e = 0.0;
+        for (float v : *out)
+            e += (double)v * v;
+        energy = std::max(energy, e);
+    }
+    float gain = (float)(1.0 / std::sqrt(energy));
+    for (std::vector<float>* out : outs)
+        for (float& v : *out)
+            v *= gain;
+    return true;
+}
+
+} // namespace dspext
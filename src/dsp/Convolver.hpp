@@ -0,0 +1,125 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <pffft.h>
+
+namespace dspext {
+
+// 16-byte aligned float storage as required by pffft
+struct AlignedFloats {
+    float* data = nullptr;
+    int size = 0;
+
+    AlignedFloats() = default;
+    AlignedFloats(const AlignedFloats&) = delete;
+    AlignedFloats& operator=(const AlignedFloats&) = delete;
+    ~AlignedFloats();
+
+    void resize(int n);
+    void zero();
+    float* operator+(int offset) const { return data + offset; }
+};
+
+// Uniformly partitioned overlap-save convolution with one IR segment.
+// Each processBlock() call takes blockSize new input samples and writes the
+// matching blockSize samples of in * ir.
+class PartitionedConvolver {
+public:
+    PartitionedConvolver() = default;
+    PartitionedConvolver(const PartitionedConvolver&) = delete;
+    PartitionedConvolver& operator=(const PartitionedConvolver&) = delete;
+    ~PartitionedConvolver();
+
+    void init(const float* ir, int length, int blockSize);
+    void processBlock(const float* in, float* out);
+    void reset();
+
+    bool empty() const { return numParts == 0; }
+
+private:
+    PFFFT_Setup* setup = nullptr;
+    int block = 0;
+    int fftSize = 0;
+    int numParts = 0;
+    int fdlPos = 0;
+    AlignedFloats irSpectra; // numParts spectra of the zero-padded IR partitions
+    AlignedFloats fdl;       // frequency-domain delay line of input spectra
+    AlignedFloats window;    // last two input blocks
+    AlignedFloats accum;
+    AlignedFloats work;
+};
+
+// Stereo convolution reverb without added latency.
+//
+// The IR is split in three segments. The first HEAD_LENGTH taps run as a
+// direct SIMD FIR. Taps up to TAIL_START run through a partitioned convolver
+// in HEAD_LENGTH blocks on the audio thread: a block is complete exactly when
+// its output is first needed. The rest runs in TAIL_BLOCK blocks on a worker
+// thread, which gets one whole block period to finish each job.
+//
+// Left input is convolved with the first IR channel, right input with the
+// second (or the first again for a mono IR).
+class ConvolutionEngine {
+public:
+    static constexpr int HEAD_LENGTH = 128;
+    static constexpr int TAIL_BLOCK = 2048;
+    static constexpr int TAIL_START = 2 * TAIL_BLOCK;
+
+    ConvolutionEngine(const std::vector<float>& irL, const std::vector<float>& irR);
+    ~ConvolutionEngine();
+    ConvolutionEngine(const ConvolutionEngine&) = delete;
+    ConvolutionEngine& operator=(const ConvolutionEngine&) = delete;
+
+    // Early is the first TAIL_START samples of the response, late the rest
+    void process(float inL, float inR, float& earlyL, float& earlyR, float& lateL, float& lateR);
+
+    int getLength() const { return length; }
+    // Tail blocks the worker did not finish in time, played as silence
+    int getMissedBlocks() const { return missedBlocks.load(std::memory_order_relaxed); }
+
+private:
+    struct Channel {
+        std::vector<float> headTaps;  // reversed, so the FIR is a forward dot product
+        std::vector<float> history;   // mirrored input history, 2 * HEAD_LENGTH
+        PartitionedConvolver mid;
+        PartitionedConvolver tail;
+        std::vector<float> midIn, midOut;
+        std::vector<float> tailIn, jobIn;
+        std::vector<float> jobOut[2];
+    };
+
+    Channel channels[2];
+    int length = 0;
+    int historyPos = 0;
+    int midPos = 0;
+    int tailPos = 0;
+    bool hasTail = false;
+    bool tailMissed = false;
+
+    // Tail jobs: the audio thread bumps submitted, the worker bumps completed
+    std::atomic<int> submitted{0};
+    std::atomic<int> completed{0};
+    std::atomic<bool> quit{false};
+    std::atomic<int> missedBlocks{0};
+    std::thread worker;
+    std::mutex workerMutex;
+    std::condition_variable workerCV;
+
+    void initChannel(Channel& ch, const std::vector<float>& ir);
+    float processHead(Channel& ch);
+    void submitTail();
+    void workerLoop();
+};
+
+// Reads a PCM (16/24/32-bit) or 32-bit float WAV file, resamples it to
+// sampleRate, trims trailing silence and normalizes it to unit energy.
+// A mono file fills both outputs. Returns false with a message in error.
+bool loadImpulseResponse(const std::string& path, float sampleRate, float maxSeconds,
+                         std::vector<float>& irL, std::vector<float>& irR, std::string& error);
+
+} // namespace dspext
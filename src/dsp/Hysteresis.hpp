@@ -0,0 +1,186 @@
+#pragma once
+#include <cmath>
+#include <dsp/resampler.hpp>
+#include "dsp.hpp"
+
+namespace dspext {
+
+// Jiles-Atherton magnetic hysteresis.
+//
+// The input is treated as the applied field H and the output is the tape
+// magnetization M, normalized so small signals pass close to unity gain.
+// dM/dt is integrated at OS times the host rate with one of three solvers,
+// trading accuracy against the number of model evaluations per sample.
+//
+// T is float or rack::simd::float_4 (four independent channels).
+template<typename T = float>
+class Hysteresis {
+public:
+    enum Solver {
+        RK2,
+        RK4,
+        NEWTON_RAPHSON,
+        SOLVERS_LEN
+    };
+
+    static constexpr int OS = 2;
+    static constexpr int NR_ITERATIONS = 3;
+
+    // Model evaluations per host sample, as shown in module menus
+    static constexpr int evalsPerSample(Solver solver) {
+        return OS * (solver == RK2 ? 2 : solver == RK4 ? 4 : 2 * NR_ITERATIONS + 1);
+    }
+
+    dsp::Upsampler<OS, 8, T> upsampler;
+    dsp::Decimator<OS, 8, T> decimator;
+
+    Hysteresis() {
+        setSampleRate(44100.f);
+        setParams(0.25f, 0.5f);
+    }
+
+    void setSampleRate(float sampleRate) {
+        fs = sampleRate * OS;
+        ts = 1.f / fs;
+    }
+
+    // drive and width in [0, 1]. Drive pushes the field towards saturation,
+    // width sets the coercivity and so the opening of the loop.
+    void setParams(float drive, float width) {
+        drive = rack::math::clamp(drive, 0.f, 1.f);
+        width = rack::math::clamp(width, 0.f, 1.f);
+        inGain = 0.5f + 2.f * drive;
+        a = 1.f / 3.f;
+        hScale = 3.f * a * inGain;
+        // Partial makeup: drive still adds level, wide loops lose less
+        outGain = (1.f + 1.2f * width) / std::sqrt(inGain);
+        k = a * (0.02f + 0.6f * width);
+        c = std::sqrt(1.f - 0.9f * width) - 0.05f;
+        nc = 1.f - c;
+        alpha = 1.6e-3f;
+    }
+
+    void reset() {
+        M = 0.f;
+        hPrev = 0.f;
+        dhPrev = 0.f;
+        fPrev = 0.f;
+        upsampler.reset();
+        decimator.reset();
+    }
+
+    T process(T in, Solver solver) {
+        // Only Newton-Raphson carries a derivative between steps. After
+        // running another solver it is stale, so reseed it from the
+        // current state rather than misconverge on the first steps.
+        if (solver != activeSolver) {
+            if (solver == NEWTON_RAPHSON)
+                fPrev = dMdt(hPrev, dhPrev, M);
+            activeSolver = solver;
+        }
+        T up[OS];
+        upsampler.process(in, up);
+        for (int i = 0; i < OS; i++) {
+            T H = up[i] * hScale;
+            T dH = (H - hPrev) * fs;
+            switch (solver) {
+                case RK4:
+                    stepRK4(H, dH);
+                    break;
+                case NEWTON_RAPHSON:
+                    stepNR(H, dH);
+                    break;
+                default:
+                    stepRK2(H, dH);
+                    break;
+            }
+            // Keep the state bounded if the solver overshoots
+            M = rack::simd::fmin(rack::simd::fmax(M, T(-1.5f * Ms)), T(1.5f * Ms));
+            hPrev = H;
+            dhPrev = dH;
+            up[i] = M * outGain;
+        }
+        return decimator.process(up);
+    }
+
+private:
+    static constexpr float Ms = 1.f;
+
+    float fs = 88200.f;
+    float ts = 1.f / 88200.f;
+    float a = 1.f / 3.f;
+    float alpha = 1.6e-3f;
+    float k = 0.1f;
+    float c = 0.5f;
+    float nc = 0.5f;
+    float inGain = 1.f;
+    float hScale = 1.f;
+    float outGain = 1.f;
+
+    T M = 0.f;
+    T hPrev = 0.f;
+    T dhPrev = 0.f;
+    T fPrev = 0.f;
+    Solver activeSolver = RK2;
+
+    // dM/dt for field H moving at dH/dt with magnetization m
+    T dMdt(T H, T dH, T m) const {
+        T Q = (H + alpha * m) * (1.f / a);
+        // Near zero coth(Q) - 1/Q cancels badly in float, so the Langevin
+        // function and its slope use their Taylor series there
+        auto small = rack::simd::fabs(Q) < 0.5f;
+        T Q2 = Q * Q;
+        T Qs = rack::simd::ifelse(small, T(1.f), Q);
+        // coth(Q) from a single exp, clamped so it cannot overflow
+        T e = rack::simd::exp(2.f * rack::simd::fmin(rack::simd::fmax(Qs, T(-20.f)), T(20.f)));
+        T coth = (e + 1.f) / (e - 1.f);
+        T invQ = 1.f / Qs;
+        T L = rack::simd::ifelse(small, Q * (1.f / 3.f - Q2 * (1.f / 45.f - Q2 * (2.f / 945.f))), coth - invQ);
+        T Lp = rack::simd::ifelse(small, 1.f / 3.f - Q2 * (1.f / 15.f - Q2 * (2.f / 189.f)), invQ * invQ - coth * coth + 1.f);
+
+        T mDiff = Ms * L - m;
+        T delta = rack::simd::ifelse(dH >= 0.f, T(1.f), T(-1.f));
+        T kap = rack::simd::ifelse(delta * mDiff > 0.f, T(1.f), T(0.f));
+        T f1 = kap * nc * mDiff / (nc * delta * k - alpha * mDiff);
+        T f2 = (c * Ms / a) * Lp;
+        T f3 = 1.f - (c * alpha * Ms / a) * Lp;
+        return dH * (f1 + f2) / f3;
+    }
+
+    void stepRK2(T H, T dH) {
+        T hMid = 0.5f * (H + hPrev);
+        T dhMid = 0.5f * (dH + dhPrev);
+        T k1 = ts * dMdt(hPrev, dhPrev, M);
+        T k2 = ts * dMdt(hMid, dhMid, M + 0.5f * k1);
+        M += k2;
+    }
+
+    void stepRK4(T H, T dH) {
+        T hMid = 0.5f * (H + hPrev);
+        T dhMid = 0.5f * (dH + dhPrev);
+        T k1 = ts * dMdt(hPrev, dhPrev, M);
+        T k2 = ts * dMdt(hMid, dhMid, M + 0.5f * k1);
+        T k3 = ts * dMdt(hMid, dhMid, M + 0.5f * k2);
+        T k4 = ts * dMdt(H, dH, M + k3);
+        M += (k1 + 2.f * k2 + 2.f * k3 + k4) * (1.f / 6.f);
+    }
+
+    // Implicit trapezoidal step solved by Newton-Raphson, with the Jacobian
+    // taken from a forward difference
+    void stepNR(T H, T dH) {
+        const float eps = 1e-4f;
+        T mPrev = M;
+        T m = mPrev;
+        for (int it = 0; it < NR_ITERATIONS; it++) {
+            T f = dMdt(H, dH, m);
+            T fEps = dMdt(H, dH, m + eps);
+            T g = m - mPrev - 0.5f * ts * (f + fPrev);
+            T dg = 1.f - 0.5f * ts * (fEps - f) * (1.f / eps);
+            m -= g / rack::simd::fmax(dg, T(0.1f));
+        }
+        M = m;
+        fPrev = dMdt(H, dH, m);
+    }
+};
+
+} // namespace dspext
@@ -0,0 +1,274 @@
+#include <algorithm>
+#include <cmath>
+#include "Loudness.hpp"
+
+namespace dspext {
+
+using rack::simd::float_4;
+
+namespace {
+
+// BS.1770-4 Annex 2 true-peak interpolation filter: 48 taps at 4x, split
+// into four 12-tap phases
+const float TRUE_PEAK_PHASES[4][LoudnessMeterBank::TRUE_PEAK_TAPS] = {
+    {0.0017089843750f, 0.0109863281250f, -0.0196533203125f, 0.0332031250000f,
+     -0.0594482421875f, 0.1373291015625f, 0.9721679687500f, -0.1022949218750f,
+     0.0476074218750f, -0.0266113281250f, 0.0148925781250f, -0.0083007812500f},
+    {-0.0291748046875f, 0.0292968750000f, -0.0517578125000f, 0.0891113281250f,
+     -0.1665039062500f, 0.4650878906250f, 0.7797851562500f, -0.2003173828125f,
+     0.1015625000000f, -0.0582275390625f, 0.0330810546875f, -0.0189208984375f},
+    {-0.0189208984375f, 0.0330810546875f, -0.0582275390625f, 0.1015625000000f,
+     -0.2003173828125f, 0.7797851562500f, 0.4650878906250f, -0.1665039062500f,
+     0.0891113281250f, -0.0517578125000f, 0.0292968750000f, -0.0291748046875f},
+    {-0.0083007812500f, 0.0148925781250f, -0.0266113281250f, 0.0476074218750f,
+     -0.1022949218750f, 0.9721679687500f, 0.1373291015625f, -0.0594482421875f,
+     0.0332031250000f, -0.0196533203125f, 0.0109863281250f, 0.0017089843750f},
+};
+
+// Phases p and 3 - p folded for processFrames():
+// even = (h[j] + h[11 - j]) / 2, odd = (h[j] - h[11 - j]) / 2
+struct FoldedPhases {
+    float even[2][LoudnessMeterBank::TRUE_PEAK_TAPS / 2];
+    float odd[2][LoudnessMeterBank::TRUE_PEAK_TAPS / 2];
+
+    FoldedPhases() {
+        const int taps = LoudnessMeterBank::TRUE_PEAK_TAPS;
+        for (int p = 0; p < 2; p++) {
+            for (int j = 0; j < taps / 2; j++) {
+                even[p][j] = 0.5f * (TRUE_PEAK_PHASES[p][j] + TRUE_PEAK_PHASES[p][taps - 1 - j]);
+                odd[p][j] = 0.5f * (TRUE_PEAK_PHASES[p][j] - TRUE_PEAK_PHASES[p][taps - 1 - j]);
+            }
+        }
+    }
+};
+
+const FoldedPhases FOLDED;
+const auto& truePeakEven = FOLDED.even;
+const auto& truePeakOdd = FOLDED.odd;
+
+const float ABSOLUTE_GATE = -70.f;
+const float RELATIVE_GATE = -10.f;
+const int HOLD_SEGMENTS = 6;           // 600 ms before the hold starts to fall
+const float HOLD_DECAY = 0.60653066f;  // exp(-0.1 / 0.2) per segment
+const float CLIP_SECONDS = 0.18f;
+
+float toLufs(double meanSquare) {
+    if (meanSquare <= 1e-12)
+        return LoudnessMeterBank::SILENCE_LUFS;
+    return std::max(LoudnessMeterBank::SILENCE_LUFS, (float)(-0.691 + 10.0 * std::log10(meanSquare)));
+}
+
+// Pre-filter (high shelf) and RLB high-pass of the K-weighting curve, as
+// analog prototypes so any sample rate gets the same response
+void kWeighting(float sampleRate, BiquadCoeffs& shelf, BiquadCoeffs& highpass) {
+    double K = std::tan(M_PI * 1681.974450955533 / sampleRate);
+    double Q = 0.7071752369554196;
+    double Vh = std::pow(10.0, 3.999843853973347 / 20.0);
+    double Vb = std::pow(Vh, 0.4996667741545416);
+    double a0 = 1.0 + K / Q + K * K;
+    shelf.b0 = (float)((Vh + Vb * K / Q + K * K) / a0);
+    shelf.b1 = (float)(2.0 * (K * K - Vh) / a0);
+    shelf.b2 = (float)((Vh - Vb * K / Q + K * K) / a0);
+    shelf.a1 = (float)(2.0 * (K * K - 1.0) / a0);
+    shelf.a2 = (float)((1.0 - K / Q + K * K) / a0);
+
+    K = std::tan(M_PI * 38.13547087602444 / sampleRate);
+    Q = 0.5003270373238773;
+    a0 = 1.0 + K / Q + K * K;
+    highpass.b0 = 1.f;
+    highpass.b1 = -2.f;
+    highpass.b2 = 1.f;
+    highpass.a1 = (float)(2.0 * (K * K - 1.0) / a0);
+    highpass.a2 = (float)((1.0 - K / Q + K * K) / a0);
+}
+
+} // namespace
+
+LoudnessMeterBank::LoudnessMeterBank() {
+    setSampleRate(44100.f);
+}
+
+void LoudnessMeterBank::setSampleRate(float sampleRate) {
+    BiquadCoeffs shelf, highpass;
+    kWeighting(sampleRate, shelf, highpass);
+    for (Lane& lane : lanes) {
+        lane.shelf.setCoeffs(shelf);
+        lane.highpass.setCoeffs(highpass);
+        lane.shelf.reset();
+        lane.highpass.reset();
+        std::fill(lane.history, lane.history + 2 * TRUE_PEAK_TAPS, float_4(0.f));
+        lane.power = 0.f;
+        lane.peak = 0.f;
+    }
+    for (int p = 0; p < POINTS; p++) {
+        gates[p] = Gate();
+        readings[p].momentary = SILENCE_LUFS;
+        readings[p].shortTerm = SILENCE_LUFS;
+        readings[p].integrated = SILENCE_LUFS;
+        readings[p].truePeak = 0.f;
+        readings[p].peakHold = 0.f;
+        readings[p].maxTruePeak = 0.f;
+        readings[p].clip = false;
+    }
+    sampleTime = 1.f / sampleRate;
+    segmentLength = std::max(1, (int)std::round(0.1f * sampleRate));
+    segmentPos = 0;
+    segmentIndex = 0;
+    segmentsSeen = 0;
+    historyPos = 0;
+    framePos = 0;
+}
+
+void LoudnessMeterBank::push(const float* left, const float* right) {
+    for (int l = 0; l < 3; l++)
+        lanes[l].frames[framePos] = float_4(left[2 * l], right[2 * l], left[2 * l + 1], right[2 * l + 1]);
+    if (++framePos == BLOCK) {
+        framePos = 0;
+        processBlock();
+    }
+}
+
+void LoudnessMeterBank::processBlock() {
+    int start = 0;
+    while (start < BLOCK) {
+        int end = std::min(BLOCK, start + segmentLength - segmentPos);
+        processFrames(start, end);
+        segmentPos += end - start;
+        start = end;
+        if (segmentPos == segmentLength) {
+            finishSegment();
+            segmentPos = 0;
+        }
+    }
+
+    // Clip indicators run per block so they light without segment latency
+    float blockTime = BLOCK * sampleTime;
+    for (int p = 0; p < POINTS; p++) {
+        const float_4& peak = lanes[p / 2].peak;
+        float blockPeak = std::max(peak[2 * (p % 2)], peak[2 * (p % 2) + 1]);
+        Gate& gate = gates[p];
+        gate.segmentPeak = std::max(gate.segmentPeak, blockPeak);
+        gate.clipTimer = (blockPeak >= 1.f) ? CLIP_SECONDS : std::max(0.f, gate.clipTimer - blockTime);
+        readings[p].clip.store(gate.clipTimer > 0.f, std::memory_order_relaxed);
+    }
+    for (Lane& lane : lanes)
+        lane.peak = 0.f;
+}
+
+void LoudnessMeterBank::processFrames(int start, int end) {
+    // Lanes are interleaved per frame so their filter recursions overlap
+    int pos = historyPos;
+    for (int n = start; n < end; n++) {
+        for (Lane& lane : lanes) {
+            float_4 x = lane.frames[n];
+
+            // Mirrored history: the last TRUE_PEAK_TAPS inputs are always
+            // contiguous, oldest first, ending with x
+            lane.history[pos] = x;
+            lane.history[pos + TRUE_PEAK_TAPS] = x;
+            const float_4* window = lane.history + pos + 1;
+
+            // Phases 3 and 2 are phases 0 and 1 reversed, so each pair is
+            // the sum and difference of a symmetric and an antisymmetric FIR
+            float_4 even0 = 0.f, odd0 = 0.f, even1 = 0.f, odd1 = 0.f;
+            for (int j = 0; j < TRUE_PEAK_TAPS / 2; j++) {
+                float_4 newer = window[TRUE_PEAK_TAPS - 1 - j];
+                float_4 older = window[j];
+                float_4 sum = newer + older;
+                float_4 diff = newer - older;
+                even0 += truePeakEven[0][j] * sum;
+                odd0 += truePeakOdd[0][j] * diff;
+                even1 += truePeakEven[1][j] * sum;
+                odd1 += truePeakOdd[1][j] * diff;
+            }
+            float_4 m = rack::simd::fmax(rack::simd::fmax(rack::simd::fabs(even0 + odd0), rack::simd::fabs(even0 - odd0)),
+                                         rack::simd::fmax(rack::simd::fabs(even1 + odd1), rack::simd::fabs(even1 - odd1)));
+            lane.peak = rack::simd::fmax(lane.peak, rack::simd::fmax(m, rack::simd::fabs(x)));
+
+            float_4 k = lane.highpass.process(lane.shelf.process(x));
+            lane.power += k * k;
+        }
+        if (++pos == TRUE_PEAK_TAPS)
+            pos = 0;
+    }
+    historyPos = pos;
+}
+
+void LoudnessMeterBank::finishSegment() {
+    bool reset = resetRequested.exchange(false);
+    float norm = 1.f / segmentLength;
+    for (int p = 0; p < POINTS; p++) {
+        Gate& gate = gates[p];
+        Reading& out = readings[p];
+        if (reset) {
+            std::fill(gate.counts, gate.counts + HISTOGRAM_BINS, 0u);
+            std::fill(gate.energies, gate.energies + HISTOGRAM_BINS, 0.0);
+            gate.gatedCount = 0;
+            gate.gatedEnergy = 0.0;
+            out.maxTruePeak = 0.f;
+        }
+
+        // Channel weights are 1 for left and right
+        const float_4& power = lanes[p / 2].power;
+        gate.segments[segmentIndex] = (power[2 * (p % 2)] + power[2 * (p % 2) + 1]) * norm;
+
+        double momentary = 0.0;
+        double shortTerm = 0.0;
+        for (int s = 0; s < SHORT_TERM_SEGMENTS; s++) {
+            int age = (segmentIndex - s + SHORT_TERM_SEGMENTS) % SHORT_TERM_SEGMENTS;
+            if (s < MOMENTARY_SEGMENTS)
+                momentary += gate.segments[age];
+            shortTerm += gate.segments[age];
+        }
+        momentary /= MOMENTARY_SEGMENTS;
+        shortTerm /= SHORT_TERM_SEGMENTS;
+
+        // Gating blocks are the 400 ms momentary windows, overlapping by 75%
+        float blockLoudness = toLufs(momentary);
+        if (segmentsSeen + 1 >= MOMENTARY_SEGMENTS && blockLoudness > ABSOLUTE_GATE) {
+            int bin = std::min(HISTOGRAM_BINS - 1, (int)((blockLoudness - ABSOLUTE_GATE) * 10.f));
+            gate.counts[bin]++;
+            gate.energies[bin] += momentary;
+            gate.gatedCount++;
+            gate.gatedEnergy += momentary;
+        }
+
+        out.momentary.store(blockLoudness, std::memory_order_relaxed);
+        out.shortTerm.store(toLufs(shortTerm), std::memory_order_relaxed);
+        out.integrated.store(integratedLoudness(gate), std::memory_order_relaxed);
+
+        float peak = gate.segmentPeak;
+        gate.segmentPeak = 0.f;
+        if (!peakHold || peak >= gate.hold) {
+            gate.hold = peak;
+            gate.holdSegments = 0;
+        } else if (++gate.holdSegments > HOLD_SEGMENTS) {
+            gate.hold = std::max(peak, gate.hold * HOLD_DECAY);
+        }
+        out.truePeak.store(peak, std::memory_order_relaxed);
+        out.peakHold.store(gate.hold, std::memory_order_relaxed);
+        if (peak > out.maxTruePeak.load(std::memory_order_relaxed))
+            out.maxTruePeak.store(peak, std::memory_order_relaxed);
+    }
+    for (Lane& lane : lanes)
+        lane.power = 0.f;
+    segmentIndex = (segmentIndex + 1) % SHORT_TERM_SEGMENTS;
+    segmentsSeen = std::min(segmentsSeen + 1, SHORT_TERM_SEGMENTS);
+}
+
+float LoudnessMeterBank::integratedLoudness(const Gate& gate) const {
+    if (gate.gatedCount == 0)
+        return SILENCE_LUFS;
+    float threshold = toLufs(gate.gatedEnergy / gate.gatedCount) + RELATIVE_GATE;
+    // Bins whose centre lies above the relative gate
+    int first = std::max(0, (int)std::floor((threshold - ABSOLUTE_GATE) * 10.f - 0.5f) + 1);
+    uint64_t count = 0;
+    double energy = 0.0;
+    for (int b = first; b < HISTOGRAM_BINS; b++) {
+        count += gate.counts[b];
+        energy += gate.energies[b];
+    }
+    return count ? toLufs(energy / count) : SILENCE_LUFS;
+}
+
+} // namespace dspext
@@ -0,0 +1,97 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <vector>
+#include <simd/functions.hpp>
+#include "dsp.hpp"
+
+namespace dspext {
+
+// ITU-R BS.1770-4 metering for six stereo meter points at once.
+//
+// The twelve channels are packed into three float_4 lanes, two points per
+// lane, and processed in blocks of BLOCK frames: K-weighting, mean square
+// per 100 ms segment, and 4x polyphase true peak. Momentary (400 ms) and
+// short-term (3 s) loudness are updated every segment. Integrated loudness
+// uses the absolute (-70 LUFS) and relative (-10 LU) gates over a 0.1 LU
+// histogram of the momentary blocks.
+//
+// Levels are relative to a full scale of 1.0. Results are published through
+// atomics and can be read from any thread.
+class LoudnessMeterBank {
+public:
+    static constexpr int POINTS = 6;
+    static constexpr int BLOCK = 32;
+    static constexpr int TRUE_PEAK_TAPS = 12;
+    static constexpr int SHORT_TERM_SEGMENTS = 30;
+    static constexpr int MOMENTARY_SEGMENTS = 4;
+    static constexpr int HISTOGRAM_BINS = 1000; // -70 to +30 LUFS
+    static constexpr float SILENCE_LUFS = -120.f;
+
+    struct Reading {
+        std::atomic<float> momentary{SILENCE_LUFS};
+        std::atomic<float> shortTerm{SILENCE_LUFS};
+        std::atomic<float> integrated{SILENCE_LUFS};
+        std::atomic<float> truePeak{0.f};    // latest segment, linear
+        std::atomic<float> peakHold{0.f};    // linear
+        std::atomic<float> maxTruePeak{0.f}; // since the last reset, linear
+        std::atomic<bool> clip{false};
+    };
+
+    bool peakHold = true;
+
+    LoudnessMeterBank();
+
+    void setSampleRate(float sampleRate);
+
+    // One frame for every point, in point order
+    void push(const float* left, const float* right);
+
+    // Clears integrated loudness and the maximum true peak. Safe to call
+    // from the UI thread; takes effect at the next segment.
+    void requestReset() { resetRequested = true; }
+
+    const Reading& reading(int point) const { return readings[point]; }
+
+private:
+    struct Lane {
+        TBiquad<rack::simd::float_4> shelf;
+        TBiquad<rack::simd::float_4> highpass;
+        rack::simd::float_4 history[2 * TRUE_PEAK_TAPS];
+        rack::simd::float_4 power = 0.f;
+        rack::simd::float_4 peak = 0.f;
+        rack::simd::float_4 frames[BLOCK];
+    };
+
+    struct Gate {
+        float segments[SHORT_TERM_SEGMENTS] = {};
+        uint32_t counts[HISTOGRAM_BINS] = {};
+        double energies[HISTOGRAM_BINS] = {};
+        uint64_t gatedCount = 0;
+        double gatedEnergy = 0.0;
+        float segmentPeak = 0.f;
+        float hold = 0.f;
+        int holdSegments = 0;
+        float clipTimer = 0.f;
+    };
+
+    Lane lanes[3];
+    Gate gates[POINTS];
+    Reading readings[POINTS];
+    std::atomic<bool> resetRequested{false};
+
+    float sampleTime = 1.f / 44100.f;
+    int segmentLength = 4410;
+    int segmentPos = 0;
+    int segmentIndex = 0;
+    int segmentsSeen = 0;
+    int historyPos = 0;
+    int framePos = 0;
+
+    void processBlock();
+    void processFrames(int start, int end);
+    void finishSegment();
+    float integratedLoudness(const Gate& gate) const;
+};
+
+} // namespace dspext
@@ -5,69 +5,114 @@
 
 namespace dspext {
 
-template<int OS>
-class Saturator {
-public:
-    dsp::Upsampler<OS, 8> upsampler;
-    dsp::Decimator<OS, 8> decimator;
-    float hpState = 0.f;
-    float preLPState = 0.f;
-    float postLPState = 0.f;
-    float env = 0.f;
-    float mix = 1.f;
-
+struct SaturatorBase {
     enum Circuit {
         EASY,
         MODERATE,
         HEAVY
     };
+};
+
+// T is float or rack::simd::float_4 (four independent channels).
+//
+// Filter coefficients are cached by setSampleRate(). Each block of OS
+// sub-samples runs in three passes: the recursive pre-filters and envelope,
+// the stateless waveshaper, and the recursive post-filter.
+template<int OS, typename T = float>
+class Saturator : public SaturatorBase {
+public:
+    dsp::Upsampler<OS, 8, T> upsampler;
+    dsp::Decimator<OS, 8, T> decimator;
+    T hpState = 0.f;
+    T preLPState = 0.f;
+    T postLPState = 0.f;
+    T env = 0.f;
+    float mix = 1.f;
+
+    float hpA = 0.f;
+    float preA = 0.f;
+    float postA = 0.f;
+
+    Saturator() {
+        setSampleRate(44100.f);
+    }
+
+    void setSampleRate(float sampleRate) {
+        hpA = onePoleCoeff(30.f, sampleRate * OS);
+        preA = onePoleCoeff(8000.f, sampleRate * OS);
+        postA = onePoleCoeff(12000.f, sampleRate * OS);
+    }
 
-    float process(float in, float drive, float sampleRate, Circuit circuit) {
+    // Clears the resampler and filter history, e.g. before a saturator that
+    // has been idle is switched back in
+    void reset() {
+        upsampler.reset();
+        decimator.reset();
+        hpState = 0.f;
+        preLPState = 0.f;
+        postLPState = 0.f;
+        env = 0.f;
+    }
+
+    T process(T in, float drive, Circuit circuit) {
         if (drive <= 0.f)
             return in;
+        // Mix of dry, cubic and rational curves for each circuit
+        float wx, wc, wr;
+        switch (circuit) {
+            default:
+            case HEAVY:
+                wx = 0.f; wc = 0.4f; wr = 0.6f;
+                break;
+            case MODERATE:
+                wx = 0.5f; wc = 0.5f; wr = 0.f;
+                break;
+            case EASY:
+                wx = 0.8f; wc = 0.2f; wr = 0.f;
+                break;
+        }
+
         // Soft limit the input to avoid digital clipping when input and drive are high
-        float norm = std::tanh(in);
-        float upBuf[OS];
-        float satBuf[OS];
-        upsampler.process(norm, upBuf);
+        T norm = tanhExp(in);
+        alignas(16) T buf[OS];
+        alignas(16) T envBuf[OS];
+        upsampler.process(norm, buf);
+
+        // Pre emphasis and envelope
         for (int i = 0; i < OS; i++) {
-            float x = upBuf[i];
-            // Pre emphasis
-            float hpA = std::exp(-2.f * M_PI * 30.f / (sampleRate * OS));
+            T x = buf[i];
             hpState = hpA * hpState + (1.f - hpA) * x;
             x -= hpState;
-            float preA = std::exp(-2.f * M_PI * 8000.f / (sampleRate * OS));
             preLPState = preA * preLPState + (1.f - preA) * x;
             x = preLPState;
-            float rect = std::fabs(x);
-            env += 0.002f * (rect - env);
-            float dynDrive = drive * (1.f + 0.2f * env);
-            float cubic = x - (x * x * x) / 3.f;
-            float rational = x * (27.f + x * x) / (27.f + 9.f * x * x);
-            float shaped = 0.f;
-            switch (circuit) {
-                default:
-                case HEAVY:
-                    shaped = 0.4f * cubic + 0.6f * rational;
-                    break;
-                case MODERATE:
-                    shaped = 0.5f * x + 0.5f * cubic;
-                    break;
-                case EASY:
-                    shaped = 0.8f * x + 0.2f * cubic;
-                    break;
-            }
-            float saturated = shaped * dynDrive;
-            // simple soft compression
-            float comp = 1.f / (1.f + 0.5f * dynDrive * env);
-            float post = saturated * comp;
-            float postA = std::exp(-2.f * M_PI * 12000.f / (sampleRate * OS));
-            postLPState = postA * postLPState + (1.f - postA) * post;
-            satBuf[i] = postLPState;
+            env += 0.002f * (simd::fabs(x) - env);
+            buf[i] = x;
+            envBuf[i] = env;
         }
-        float sat = decimator.process(satBuf);
+
+        for (int i = 0; i < OS; i++)
+            buf[i] = shape(buf[i], envBuf[i], drive, wx, wc, wr);
+
+        for (int i = 0; i < OS; i++) {
+            postLPState = postA * postLPState + (1.f - postA) * buf[i];
+            buf[i] = postLPState;
+        }
+        T sat = decimator.process(buf);
         return sat * mix + in * (1.f - mix);
     }
+
+private:
+    static T shape(T x, T env, float drive, float wx, float wc, float wr) {
+        T dynDrive = drive * (1.f + 0.2f * env);
+        T x2 = x * x;
+        T cubic = x - x2 * x / 3.f;
+        T rational = x * (27.f + x2) / (27.f + 9.f * x2);
+        T shaped = wx * x + wc * cubic + wr * rational;
+        T saturated = shaped * dynDrive;
+        // simple soft compression
+        T comp = 1.f / (1.f + 0.5f * dynDrive * env);
+        return saturated * comp;
+    }
 };
 
 } // namespace dspext
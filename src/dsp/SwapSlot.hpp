@@ -0,0 +1,51 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace dspext {
+
+// Hands objects built on a background thread to the audio thread. The
+// worker publish()es; process() take()s, parking the object it replaces,
+// which the worker frees on its next publish. Nothing is taken while an
+// object is still parked, so the audio thread never allocates or frees.
+template <typename T>
+struct SwapSlot {
+    std::atomic<T*> pending{nullptr};
+    std::atomic<T*> retired{nullptr};
+    std::atomic<bool> cancelled{false};
+
+    ~SwapSlot() {
+        delete pending.exchange(nullptr);
+        delete retired.exchange(nullptr);
+    }
+
+    // Worker thread
+    void publish(T* object) {
+        delete retired.exchange(nullptr);
+        // An object that was never picked up is dropped here
+        delete pending.exchange(object);
+        // Give process() up to a second to take it, then free the one it replaced
+        for (int i = 0; i < 100 && pending.load() && !cancelled.load(); i++)
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        if (!pending.load())
+            delete retired.exchange(nullptr);
+    }
+
+    // Any thread, at shutdown: a publish() in progress stops waiting for
+    // process(), and whatever is left is freed by the destructor
+    void cancel() {
+        cancelled.store(true);
+    }
+
+    // Audio thread. Returns true when current was replaced.
+    bool take(T*& current) {
+        if (!pending.load() || retired.load())
+            return false;
+        retired.store(current);
+        current = pending.exchange(nullptr);
+        return true;
+    }
+};
+
+} // namespace dspext
@@ -0,0 +1,127 @@
+#pragma once
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include "framework/processor.h"
+#include "utilities/smooth_value.h"
+
+namespace dspext {
+
+// Runs a vendored Vital processor inside a Rack module.
+//
+// Owns the processor, the Output feeding its audio input and every SmoothValue
+// plugged into its parameter inputs. Rack frames are collected into an internal
+// block and the Vital graph is processed once per block, so the host adds a
+// fixed latency of (blockSize - 1) samples. A block size of 1 runs the graph
+// every sample with zero latency.
+//
+// Frames are packed into poly_float lanes: lane 0 = left, lane 1 = right.
+// On SSE builds lanes 2/3 carry a second stereo voice.
+template<typename P>
+class VitalHost {
+public:
+    static constexpr int LANES = vital::poly_float::kSize;
+    static constexpr int VOICES = LANES / 2;
+
+    VitalHost() = default;
+    VitalHost(const VitalHost&) = delete;
+    VitalHost& operator=(const VitalHost&) = delete;
+
+    void init(int audioInput, int audioOutput, int blockSize = 1) {
+        processor = std::make_unique<P>();
+        input = std::make_unique<vital::Output>(vital::kMaxBufferSize);
+        processor->plug(input.get(), audioInput);
+        outputIndex = audioOutput;
+        this->blockSize = std::max(1, std::min(blockSize, vital::kMaxBufferSize));
+        held.assign(vital::kMaxBufferSize, vital::poly_float(0.f));
+        pos = 0;
+    }
+
+    // Plugs a new smoothed parameter into the processor and returns its slot.
+    int addParam(int inputIndex, float value = 0.f) {
+        values.push_back(std::make_unique<vital::SmoothValue>(value));
+        values.back()->setSampleRate(sampleRate);
+        processor->plug(values.back().get(), inputIndex);
+        return (int)values.size() - 1;
+    }
+
+    void setParam(int slot, vital::poly_float value) {
+        values[slot]->set(value);
+    }
+
+    void setParamHard(int slot, vital::poly_float value) {
+        values[slot]->setHard(value);
+    }
+
+    void setSampleRate(float sr) {
+        sampleRate = std::max(1, (int)sr);
+        if (processor)
+            processor->setSampleRate(sampleRate);
+        for (auto& v : values)
+            v->setSampleRate(sampleRate);
+    }
+
+    void reset() {
+        if (!processor)
+            return;
+        processor->reset(vital::poly_mask(-1));
+        input->clearBuffer();
+        std::fill(held.begin(), held.end(), vital::poly_float(0.f));
+        pos = 0;
+    }
+
+    int getLatency() const { return blockSize - 1; }
+
+    // True when the next frame starts a new block. Modules can use this to
+    // refresh parameters at block rate instead of every sample.
+    bool atBlockStart() const { return pos == 0; }
+
+    // Pushes one frame of LANES floats and returns the frame produced
+    // getLatency() samples earlier.
+    void process(const float* in, float* out) {
+        vital::mono_float* dst = (vital::mono_float*)(input->buffer + pos);
+        for (int l = 0; l < LANES; ++l)
+            dst[l] = in[l];
+
+        if (++pos == blockSize) {
+            runBlock();
+            pos = 0;
+        }
+
+        const vital::mono_float* src = (const vital::mono_float*)(held.data() + pos);
+        for (int l = 0; l < LANES; ++l)
+            out[l] = src[l];
+    }
+
+    void processStereo(float inL, float inR, float& outL, float& outR) {
+        float in[LANES] = {};
+        float out[LANES];
+        in[0] = inL;
+        in[1] = inR;
+        process(in, out);
+        outL = out[0];
+        outR = out[1];
+    }
+
+    P* get() { return processor.get(); }
+
+private:
+    void runBlock() {
+        for (auto& v : values)
+            v->process(blockSize);
+        processor->process(blockSize);
+        const vital::poly_float* res = processor->output(outputIndex)->buffer;
+        std::copy(res, res + blockSize, held.begin());
+    }
+
+    std::unique_ptr<P> processor;
+    std::unique_ptr<vital::Output> input;
+    std::vector<std::unique_ptr<vital::SmoothValue>> values;
+    std::vector<vital::poly_float> held;
+    int outputIndex = 0;
+    int blockSize = 1;
+    int pos = 0;
+    int sampleRate = vital::kDefaultSampleRate;
+};
+
+} // namespace dspext
@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include "Wav.hpp"
+
+namespace dspext {
+
+namespace {
+
+// Above any rate an audio interface runs at; larger header values are
+// taken as a corrupt file
+const uint32_t MAX_SAMPLE_RATE = 768000;
+
+uint32_t readLE(const uint8_t* p, int bytes) {
+    uint32_t v = 0;
+    for (int i = 0; i < bytes; i++)
+        v |= (uint32_t)p[i] << (8 * i);
+    return v;
+}
+
+} // namespace
+
+bool readFileBytes(const std::string& path, size_t maxBytes, std::vector<uint8_t>& bytes, std::string& error) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) {
+        error = "cannot open file";
+        return false;
+    }
+    std::streamoff size = file.tellg();
+    if (size < 0) {
+        error = "cannot read file";
+        return false;
+    }
+    if ((uint64_t)size > maxBytes) {
+        error = "file is too large";
+        return false;
+    }
+    bytes.resize((size_t)size);
+    file.seekg(0);
+    if (!file.read(reinterpret_cast<char*>(bytes.data()), size)) {
+        error = "cannot read file";
+        return false;
+    }
+    return true;
+}
+
+bool readWavInfo(const std::vector<uint8_t>& bytes, WavInfo& info, std::string& error) {
+    if (bytes.size() < 12 || std::memcmp(bytes.data(), "RIFF", 4) != 0 || std::memcmp(bytes.data() + 8, "WAVE", 4) != 0) {
+        error = "not a WAV file";
+        return false;
+    }
+
+    int format = 0, fileChannels = 0, bits = 0;
+    uint32_t fileRate = 0;
+    const uint8_t* data = nullptr;
+    size_t dataSize = 0;
+    size_t pos = 12;
+    while (pos + 8 <= bytes.size()) {
+        const uint8_t* chunk = bytes.data() + pos;
+        size_t size = readLE(chunk + 4, 4);
+        size_t avail = std::min(size, bytes.size() - pos - 8);
+        if (std::memcmp(chunk, "fmt ", 4) == 0 && avail >= 16) {
+            format = (int)readLE(chunk + 8, 2);
+            fileChannels = (int)readLE(chunk + 10, 2);
+            fileRate = readLE(chunk + 12, 4);
+            bits = (int)readLE(chunk + 22, 2);
+            // WAVE_FORMAT_EXTENSIBLE carries the real format in its sub-format GUID
+            if (format == 0xFFFE && avail >= 26)
+                format = (int)readLE(chunk + 32, 2);
+        }
+        else if (std::memcmp(chunk, "data", 4) == 0) {
+            data = chunk + 8;
+            dataSize = avail;
+        }
+        pos += 8 + size + (size & 1);
+    }
+
+    bool pcm = format == 1 && (bits == 16 || bits == 24 || bits == 32);
+    bool ieee = format == 3 && bits == 32;
+    if (!data || fileChannels < 1 || fileRate == 0 || (!pcm && !ieee)) {
+        error = "unsupported WAV format (use 16/24/32-bit PCM or 32-bit float)";
+        return false;
+    }
+    if (fileRate > MAX_SAMPLE_RATE) {
+        error = "unsupported WAV sample rate";
+        return false;
+    }
+
+    int frameBytes = fileChannels * bits / 8;
+    int frames = (int)std::min(dataSize / frameBytes, (size_t)INT_MAX);
+    if (frames < 1) {
+        error = "WAV file has no audio";
+        return false;
+    }
+
+    info.channels = fileChannels;
+    info.bits = bits;
+    info.ieee = ieee;
+    info.sampleRate = fileRate;
+    info.frames = frames;
+    info.dataOffset = (size_t)(data - bytes.data());
+    return true;
+}
+
+int decodeWav(const std::vector<uint8_t>& bytes, const WavInfo& info, int maxChannels, int maxFrames,
+              std::vector<float>* channels) {
+    int numChannels = std::min(info.channels, maxChannels);
+    int frames = std::min(info.frames, maxFrames);
+    int frameBytes = info.channels * info.bits / 8;
+    const uint8_t* data = bytes.data() + info.dataOffset;
+    for (int c = 0; c < numChannels; c++)
+        channels[c].resize(frames);
+    for (int i = 0; i < frames; i++) {
+        for (int c = 0; c < numChannels; c++) {
+            const uint8_t* s = data + (size_t)i * frameBytes + c * info.bits / 8;
+            float v;
+            if (info.ieee) {
+                uint32_t u = readLE(s, 4);
+                std::memcpy(&v, &u, 4);
+            }
+            else if (info.bits == 16) {
+                v = (int16_t)readLE(s, 2) * (1.f / 32768.f);
+            }
+            else if (info.bits == 24) {
+                // Sign-extend from the top of a 32-bit word
+                v = (int32_t)(readLE(s, 3) << 8) * (1.f / 2147483648.f);
+            }
+            else {
+                v = (int32_t)readLE(s, 4) * (1.f / 2147483648.f);
+            }
+            channels[c][i] = std::isfinite(v) ? v : 0.f;
+        }
+    }
+    return numChannels;
+}
+
+} // namespace dspext
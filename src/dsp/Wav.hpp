@@ -0,0 +1,32 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace dspext {
+
+// Reads a whole file of at most maxBytes. Returns false with a message in
+// error.
+bool readFileBytes(const std::string& path, size_t maxBytes, std::vector<uint8_t>& bytes, std::string& error);
+
+// Layout of a PCM (16/24/32-bit) or 32-bit float WAV file held in memory
+struct WavInfo {
+    int channels = 0;
+    int bits = 0;
+    bool ieee = false;
+    uint32_t sampleRate = 0;
+    int frames = 0;
+    size_t dataOffset = 0;
+};
+
+// Parses the header chunks, so callers can size their limits before
+// decoding. Returns false with a message in error.
+bool readWavInfo(const std::vector<uint8_t>& bytes, WavInfo& info, std::string& error);
+
+// Decodes at most maxFrames frames of the first maxChannels channels of a
+// file parsed by readWavInfo. Returns how many channels were filled.
+int decodeWav(const std::vector<uint8_t>& bytes, const WavInfo& info, int maxChannels, int maxFrames,
+              std::vector<float>* channels);
+
+} // namespace dspext
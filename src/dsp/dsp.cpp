@@ -34,22 +34,26 @@ static void calcShelf(float sampleRate, float freq, float gainDb, float slope,
     }
 }
 
-void Biquad::setLowShelf(float sampleRate, float freq, float gainDb, float slope) {
+BiquadCoeffs lowShelfCoeffs(float sampleRate, float freq, float gainDb, float slope) {
     float bb0, bb1, bb2, aa0, aa1, aa2;
     calcShelf(sampleRate, freq, gainDb, slope, false, bb0, bb1, bb2, aa0, aa1, aa2);
-    b0 = bb0 / aa0;
-    b1 = bb1 / aa0;
-    b2 = bb2 / aa0;
-    a1 = aa1 / aa0;
-    a2 = aa2 / aa0;
+    BiquadCoeffs c;
+    c.b0 = bb0 / aa0;
+    c.b1 = bb1 / aa0;
+    c.b2 = bb2 / aa0;
+    c.a1 = aa1 / aa0;
+    c.a2 = aa2 / aa0;
+    return c;
 }
 
-void Biquad::setHighShelf(float sampleRate, float freq, float gainDb, float slope) {
+BiquadCoeffs highShelfCoeffs(float sampleRate, float freq, float gainDb, float slope) {
     float bb0, bb1, bb2, aa0, aa1, aa2;
     calcShelf(sampleRate, freq, gainDb, slope, true, bb0, bb1, bb2, aa0, aa1, aa2);
-    b0 = bb0 / aa0;
-    b1 = bb1 / aa0;
-    b2 = bb2 / aa0;
-    a1 = aa1 / aa0;
-    a2 = aa2 / aa0;
+    BiquadCoeffs c;
+    c.b0 = bb0 / aa0;
+    c.b1 = bb1 / aa0;
+    c.b2 = bb2 / aa0;
+    c.a1 = aa1 / aa0;
+    c.a2 = aa2 / aa0;
+    return c;
 }
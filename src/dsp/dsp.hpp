@@ -1,23 +1,238 @@
 #pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <simd/functions.hpp>
 
 float lin_to_log(float lin);
 
-struct Biquad {
+// Feedback coefficient of a one-pole lowpass: y += (1 - a) * (x - y)
+inline float onePoleCoeff(float cutoff, float sampleRate) {
+    return std::exp(-2.f * (float)M_PI * cutoff / sampleRate);
+}
+
+// Small seeded PRNG for modulation and noise that must render reproducibly
+struct XorShift32 {
+    uint32_t state = 0x9E3779B9u;
+
+    void seed(uint32_t s) {
+        state = s ? s : 0x9E3779B9u;
+    }
+
+    uint32_t next() {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    // [0, 1)
+    float uniform() {
+        return (next() >> 8) * (1.f / 16777216.f);
+    }
+
+    // [-1, 1)
+    float bipolar() {
+        return 2.f * uniform() - 1.f;
+    }
+};
+
+// Four independent white noise streams, one per float_4 lane. A 32-bit LCG
+// per lane; the signed state converts straight to a bipolar float, so only
+// the high bits matter.
+struct NoiseGenerator4 {
+    rack::simd::int32_4 state = 1;
+
+    void seed(uint32_t s) {
+        XorShift32 mix;
+        mix.seed(s);
+        state = rack::simd::int32_4((int32_t)mix.next(), (int32_t)mix.next(), (int32_t)mix.next(), (int32_t)mix.next());
+    }
+
+    // [-1, 1)
+    rack::simd::float_4 white() {
+        state = state * rack::simd::int32_4(1664525) + rack::simd::int32_4(1013904223);
+        return rack::simd::float_4(state) * (1.f / 2147483648.f);
+    }
+};
+
+// Shared sine lookup with linear interpolation. Phase is in cycles.
+struct SineTable {
+    static constexpr int SIZE = 1024;
+    float table[SIZE + 1];
+
+    SineTable() {
+        for (int i = 0; i <= SIZE; i++)
+            table[i] = std::sin(2.f * (float)M_PI * i / SIZE);
+    }
+
+    float operator()(float phase) const {
+        phase -= std::floor(phase);
+        float pos = phase * SIZE;
+        int i = std::min((int)pos, SIZE - 1);
+        float frac = pos - i;
+        return table[i] + frac * (table[i + 1] - table[i]);
+    }
+
+    static const SineTable& get() {
+        static const SineTable instance;
+        return instance;
+    }
+};
+
+// sin(2 pi x) for any x, from an odd Taylor polynomial on a quarter
+// period. Within 1e-7 of sin; no table, so it vectorizes cleanly.
+inline rack::simd::float_4 sin2pi(rack::simd::float_4 x) {
+    x -= rack::simd::floor(x + 0.5f);
+    // Fold [-0.5, 0.5] onto [-0.25, 0.25]
+    x = rack::simd::ifelse(x > 0.25f, 0.5f - x, x);
+    x = rack::simd::ifelse(x < -0.25f, -0.5f - x, x);
+    rack::simd::float_4 y = x * (2.f * (float)M_PI);
+    rack::simd::float_4 y2 = y * y;
+    return y * (1.f + y2 * (-1.f / 6.f + y2 * (1.f / 120.f + y2 * (-1.f / 5040.f
+        + y2 * (1.f / 362880.f + y2 * (-1.f / 39916800.f))))));
+}
+
+// tanh from one exp. Works on float and rack::simd::float_4.
+template <typename T>
+inline T tanhExp(T x) {
+    T e = rack::simd::exp(2.f * rack::simd::fmin(rack::simd::fmax(x, T(-9.f)), T(9.f)));
+    return (e - 1.f) / (e + 1.f);
+}
+
+struct BiquadCoeffs {
     float b0 = 1.f, b1 = 0.f, b2 = 0.f;
     float a1 = 0.f, a2 = 0.f;
-    float z1 = 0.f, z2 = 0.f;
+};
+
+BiquadCoeffs lowShelfCoeffs(float sampleRate, float freq, float gainDb, float slope = 1.f);
+BiquadCoeffs highShelfCoeffs(float sampleRate, float freq, float gainDb, float slope = 1.f);
+
+// Shelf coefficients that are only recomputed when sample rate, frequency or
+// gain change. New targets are reached by a linear ramp over rampSamples
+// calls to tick(), so block-rate updates do not zipper.
+struct ShelfCoeffCache {
+    bool high = false;
+    float sampleRate = 0.f;
+    float freq = 0.f;
+    float gainDb = 0.f;
+    BiquadCoeffs current, target, delta;
+    int rampLeft = 0;
+
+    explicit ShelfCoeffCache(bool high = false) : high(high) {}
+
+    void update(float sr, float f, float g, int rampSamples) {
+        if (sr == sampleRate && f == freq && g == gainDb)
+            return;
+        bool jump = (sr != sampleRate) || rampSamples <= 1;
+        sampleRate = sr;
+        freq = f;
+        gainDb = g;
+        target = high ? highShelfCoeffs(sr, f, g) : lowShelfCoeffs(sr, f, g);
+        if (jump) {
+            current = target;
+            rampLeft = 0;
+            return;
+        }
+        float k = 1.f / rampSamples;
+        delta.b0 = (target.b0 - current.b0) * k;
+        delta.b1 = (target.b1 - current.b1) * k;
+        delta.b2 = (target.b2 - current.b2) * k;
+        delta.a1 = (target.a1 - current.a1) * k;
+        delta.a2 = (target.a2 - current.a2) * k;
+        rampLeft = rampSamples;
+    }
+
+    // True once a zero-gain target has been reached: the shelf is a no-op
+    bool isFlat() const {
+        return rampLeft == 0 && gainDb == 0.f;
+    }
+
+    void tick() {
+        if (rampLeft <= 0)
+            return;
+        if (--rampLeft == 0) {
+            current = target;
+            return;
+        }
+        current.b0 += delta.b0;
+        current.b1 += delta.b1;
+        current.b2 += delta.b2;
+        current.a1 += delta.a1;
+        current.a2 += delta.a2;
+    }
+};
+
+// Lets a stage be skipped while it has no audible effect. When the stage is
+// switched back on its output is crossfaded in over fadeSamples frames, so
+// stale filter state does not click.
+struct StageFade {
+    bool active = true;
+    float gain = 1.f;
+    float step = 0.f;
+
+    // Returns true on the call that switches the stage back on
+    bool set(bool on, int fadeSamples) {
+        bool rising = on && !active;
+        active = on;
+        if (rising) {
+            gain = 0.f;
+            step = 1.f / fadeSamples;
+        }
+        return rising;
+    }
+
+    template <typename T>
+    T apply(T dry, T wet) const {
+        return (gain >= 1.f) ? wet : dry + (wet - dry) * gain;
+    }
+
+    void tick() {
+        if (gain < 1.f)
+            gain = std::min(1.f, gain + step);
+    }
+};
+
+// T is float or rack::simd::float_4. Coefficients are shared by all lanes.
+template <typename T>
+struct TBiquad {
+    float b0 = 1.f, b1 = 0.f, b2 = 0.f;
+    float a1 = 0.f, a2 = 0.f;
+    T z1 = 0.f, z2 = 0.f;
 
     void reset() {
         z1 = z2 = 0.f;
     }
 
-    float process(float in) {
-        float out = b0 * in + z1;
+    T process(T in) {
+        T out = b0 * in + z1;
         z1 = b1 * in + z2 - a1 * out;
         z2 = b2 * in - a2 * out;
         return out;
     }
 
-    void setLowShelf(float sampleRate, float freq, float gainDb, float slope = 1.f);
-    void setHighShelf(float sampleRate, float freq, float gainDb, float slope = 1.f);
+    // Runs the filter state with externally owned (e.g. cached) coefficients
+    T process(T in, const BiquadCoeffs& c) {
+        T out = c.b0 * in + z1;
+        z1 = c.b1 * in + z2 - c.a1 * out;
+        z2 = c.b2 * in - c.a2 * out;
+        return out;
+    }
+
+    void setCoeffs(const BiquadCoeffs& c) {
+        b0 = c.b0;
+        b1 = c.b1;
+        b2 = c.b2;
+        a1 = c.a1;
+        a2 = c.a2;
+    }
+
+    void setLowShelf(float sampleRate, float freq, float gainDb, float slope = 1.f) {
+        setCoeffs(lowShelfCoeffs(sampleRate, freq, gainDb, slope));
+    }
+    void setHighShelf(float sampleRate, float freq, float gainDb, float slope = 1.f) {
+        setCoeffs(highShelfCoeffs(sampleRate, freq, gainDb, slope));
+    }
 };
+
+typedef TBiquad<float> Biquad;
@@ -22,6 +22,7 @@ extern Model* modelLilithAdvance;
 extern Model* modelNergalAmp;
 extern Model* modelBuer;
 extern Model* modelXezbeth4X;
+extern Model* modelXezbeth4XExpander;
 extern Model* modelSabnockOTT;
 
 struct TuringVoltsExpanderMessage {